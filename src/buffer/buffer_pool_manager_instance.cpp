@@ -0,0 +1,1123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <list>
+#include <new>
+#include <unordered_set>
+#include <utility>
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size, size_t correlated_window)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, max_pool_size,
+                                correlated_window) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size,
+                                                     size_t correlated_window)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      frame_arena_(max_pool_size_),
+      page_table_(max_pool_size_),
+      disk_scheduler_(disk_manager != nullptr ? std::make_unique<DiskScheduler>(disk_manager) : nullptr) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // The frame data is one consecutive, page-aligned block of memory in the arena. The metadata of each frame points
+  // into it and sits on cache lines of its own.
+  // Room is made for max_pool_size_ frames, but only the metadata of frames in use is constructed.
+  pages_ = static_cast<Page *>(::operator new[](max_pool_size_ * sizeof(Page), std::align_val_t{alignof(Page)}));
+  for (; num_frames_ < pool_size_; ++num_frames_) {
+    new (&pages_[num_frames_]) Page(frame_arena_.GetFrame(static_cast<frame_id_t>(num_frames_)));
+  }
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_, LRUK_REPLACER_K, correlated_window);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
+  io_in_progress_.reset(new std::atomic<bool>[max_pool_size_]);
+  frame_rings_.reset(new std::atomic<FrameRing *>[max_pool_size_]);
+  SetRingCapacities();
+
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    io_in_progress_[i] = false;
+    frame_rings_[i] = nullptr;
+  }
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].pin_count_ = FRAME_LOCKED;
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopWarmUp();
+  StopBackgroundWriter();
+  if (prefetch_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      enable_prefetcher_ = false;
+    }
+    prefetch_cv_.notify_all();
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  for (size_t i = 0; i < num_frames_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_, std::align_val_t{alignof(Page)});
+  delete replacer_;
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, AccessType access_type) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+
+  // Hits on resident pages do not need the latch.
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && TryPinResident(frame_id, page_id, access_type)) {
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // A victim that is still being written back must reach the disk before it can be read in again. The same holds for
+  // a copy written by the background writer, unless the page is still resident.
+  io_cv_.wait(lock, [&] {
+    return evicting_pages_.count(page_id) == 0 &&
+           (page_table_.Contains(page_id) || bg_writing_pages_.count(page_id) == 0);
+  });
+
+  if (page_table_.Find(page_id, &frame_id)) {
+    // A frame that goes away while the pool shrinks is emptied right away if nobody uses it, and the page is read into
+    // another frame. Otherwise it is pinned once more, and Resize empties it after the last unpin.
+    if (static_cast<size_t>(frame_id) >= pool_size_ && LockFrame(frame_id)) {
+      RetireFrame(&lock, frame_id);
+      lock.unlock();
+      return FetchPageImpl(page_id, access_type);
+    }
+
+    // Resident frames are never locked while the latch is free, so the pin count is not negative here.
+    Page *page = &pages_[frame_id];
+    if (page->pin_count_++ == 0) {
+      replacer_->Pin(frame_id);
+    }
+    // Scans do not count as a use of the page. A page in a ring that is used normally is handed to the replacer
+    // when it is unpinned.
+    if (access_type == AccessType::Normal) {
+      if (frame_rings_[frame_id] != nullptr) {
+        RemoveFromRing(frame_id);
+      }
+      replacer_->RecordAccess(frame_id);
+    }
+
+    // Another thread may still be reading the page in. Our pin keeps the frame from being reused meanwhile.
+    io_cv_.wait(lock, [&] { return !io_in_progress_[frame_id]; });
+    return page;
+  }
+
+  EvictedPage evicted;
+  FrameRing *ring = GetRing(access_type);
+  if (ring != nullptr ? !FindRingFrame(ring, &frame_id, &evicted) : !FindFreeFrame(&frame_id, &evicted)) {
+    if (!WaitForPrefetch(&lock)) {
+      return nullptr;
+    }
+    // The page itself may have been read in meanwhile, so start over.
+    lock.unlock();
+    return FetchPageImpl(page_id, access_type);
+  }
+
+  ++num_misses_;
+  return InstallPage(&lock, frame_id, page_id, evicted, true);
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // The caller holds a pin, so the frame cannot be reused and the latch is not needed.
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].page_id_ != page_id) {
+    return false;
+  }
+  return UnpinFrame(frame_id, is_dirty);
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // The frame content is only valid once its I/O has finished, and an older copy from the background writer must not
+  // land on top of what is written here.
+  frame_id_t frame_id;
+  bool found = page_table_.Find(page_id, &frame_id);
+  while (found && (io_in_progress_[frame_id] || bg_writing_pages_.count(page_id) > 0)) {
+    io_cv_.wait(lock);
+    found = page_table_.Find(page_id, &frame_id);
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  Page *page = &pages_[frame_id];
+  disk_manager_->WritePage(page_id, page->data_);
+  page->is_dirty_ = false;
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id) {
+  return NewPageNearImpl(page_id, INVALID_PAGE_ID, INVALID_OWNER_ID);
+}
+
+Page *BufferPoolManagerInstance::NewPageNearImpl(page_id_t *page_id, page_id_t hint, owner_id_t owner) {
+  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // An id that a stale copy still uses is kept allocated until another id is found, so that it is not taken again.
+  std::vector<page_id_t> stale_page_ids;
+  Page *page;
+  bool in_use;
+  do {
+    *page_id = disk_manager_->AllocatePage(hint, owner);
+    page = CreatePage(&lock, *page_id, &in_use);
+    if (in_use) {
+      stale_page_ids.push_back(*page_id);
+    }
+  } while (page == nullptr && in_use);
+
+  for (auto stale_page_id : stale_page_ids) {
+    disk_manager_->DeallocatePage(stale_page_id);
+  }
+  if (page == nullptr) {
+    disk_manager_->DeallocatePage(*page_id);
+    *page_id = INVALID_PAGE_ID;
+  }
+  return page;
+}
+
+void BufferPoolManagerInstance::ReleaseOwnerImpl(owner_id_t owner) { disk_manager_->ReleaseOwner(owner); }
+
+Page *BufferPoolManagerInstance::NewPageWithId(page_id_t page_id, bool *in_use) {
+  BUSTUB_ASSERT(static_cast<uint32_t>(page_id) % num_instances_ == instance_index_,
+                "Allocated pages must mod back to this BPI");
+  std::unique_lock<std::mutex> lock(latch_);
+  return CreatePage(&lock, page_id, in_use);
+}
+
+Page *BufferPoolManagerInstance::CreatePage(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool *in_use) {
+  *in_use = false;
+  frame_id_t frame_id;
+  EvictedPage evicted;
+  while (true) {
+    // A copy that stayed resident would give the page a second frame, and one that is being evicted could still be
+    // put in the compressed cache. Both are checked again after every wait, as a copy can be read in meanwhile.
+    io_cv_.wait(*lock, [&] { return evicting_pages_.count(page_id) == 0; });
+    if (page_table_.Find(page_id, &frame_id)) {
+      if (!LockFrame(frame_id)) {
+        *in_use = true;
+        return nullptr;
+      }
+      DropPage(frame_id);
+    }
+    if (FindFreeFrame(&frame_id, &evicted)) {
+      break;
+    }
+    if (!WaitForPrefetch(lock)) {
+      return nullptr;
+    }
+  }
+
+  return InstallPage(lock, frame_id, page_id, evicted, false);
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // A prefetched page is unpinned while it is being read in. A write-back of the page, as a victim or by the
+  // background writer, and the compression of a victim must end as well, or they could land after the id is
+  // allocated again.
+  frame_id_t frame_id;
+  bool found;
+  io_cv_.wait(lock, [&] {
+    found = page_table_.Find(page_id, &frame_id);
+    return (!found || !io_in_progress_[frame_id]) && evicting_pages_.count(page_id) == 0 &&
+           bg_writing_pages_.count(page_id) == 0;
+  });
+
+  if (!found) {
+    if (compressed_cache_ != nullptr) {
+      compressed_cache_->Erase(page_id);
+    }
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+
+  if (!LockFrame(frame_id)) {
+    return false;
+  }
+
+  disk_manager_->DeallocatePage(page_id);
+  DropPage(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::DropPage(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+
+  if (frame_rings_[frame_id] != nullptr) {
+    RemoveFromRing(frame_id);
+  }
+  replacer_->Remove(frame_id);
+  page_table_.Erase(page_id);
+  // A frame that goes away while the pool shrinks stays locked, and Resize is told that it is empty.
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.emplace_back(frame_id);
+  } else {
+    io_cv_.notify_all();
+  }
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  // You can do it!
+  std::unique_lock<std::mutex> lock(latch_);
+  io_cv_.wait(lock, [&] { return bg_writing_pages_.empty(); });
+
+  std::vector<Page *> dirty_pages;
+  CollectDirtyPages(&dirty_pages);
+  lock.unlock();
+
+  WriteBackPages(disk_manager_, dirty_pages);
+  UnpinCollectedPages(dirty_pages.begin(), dirty_pages.end());
+}
+
+void BufferPoolManagerInstance::CollectDirtyPages(std::vector<Page *> *dirty_pages) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    Page *page = &pages_[i];
+    // Free frames are clean. Frames with I/O in progress hold a page that is being read in, which is clean too. Locked
+    // frames are written back by whoever evicts their page.
+    if (!page->is_dirty_ || io_in_progress_[i] || page->pin_count_ < 0) {
+      continue;
+    }
+    // Locked frames are only unlocked with the latch held, so the pin count stays non-negative. The pin keeps the
+    // frame from being reused while it is written with the latch released. The page is marked clean first, so that
+    // changes made during the write dirty it again.
+    if (page->pin_count_++ == 0) {
+      replacer_->Pin(static_cast<frame_id_t>(i));
+    }
+    page->is_dirty_ = false;
+    dirty_pages->push_back(page);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinCollectedPages(std::vector<Page *>::const_iterator begin,
+                                                    std::vector<Page *>::const_iterator end) {
+  for (auto iter = begin; iter != end; ++iter) {
+    UnpinFrame(static_cast<frame_id_t>(*iter - pages_), false);
+  }
+}
+
+void BufferPoolManagerInstance::WriteBackPages(DiskManager *disk_manager, const std::vector<Page *> &pages) {
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  writes.reserve(pages.size());
+  for (auto *page : pages) {
+    writes.emplace_back(page->page_id_, page->data_);
+  }
+  disk_manager->WritePages(std::move(writes));
+}
+
+bool BufferPoolManagerInstance::FindFreeFrame(frame_id_t *frame_id, EvictedPage *evicted) {
+  *evicted = EvictedPage{};
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+
+  bool found = false;
+  bool from_ring = false;
+  while (!found && replacer_->Victim(frame_id)) {
+    // A victim that was pinned without the latch in the meantime goes back to the replacer when it is unpinned.
+    // Frames that go away because the pool shrinks are emptied by Resize.
+    found = static_cast<size_t>(*frame_id) < pool_size_ && LockFrame(*frame_id);
+  }
+  if (!found) {
+    // Every frame outside the rings is pinned, so take one back from a ring rather than fail.
+    size_t i = 0;
+    while (i < pool_size_ && (frame_rings_[i] == nullptr || !LockFrame(static_cast<frame_id_t>(i)))) {
+      ++i;
+    }
+    if (i == pool_size_) {
+      return false;
+    }
+    *frame_id = static_cast<frame_id_t>(i);
+  }
+  // A late unpin may have handed a frame to the replacer after a ring took it over.
+  if (frame_rings_[*frame_id] != nullptr) {
+    RemoveFromRing(*frame_id);
+    from_ring = true;
+  }
+
+  Page *page = &pages_[*frame_id];
+  evicted->write_back_ = page->is_dirty_;
+  evicted->compress_ = compressed_cache_ != nullptr && !from_ring;
+  if (evicted->write_back_ || evicted->compress_) {
+    evicted->page_id_ = page->page_id_;
+  }
+  page_table_.Erase(page->page_id_);
+  return true;
+}
+
+void BufferPoolManagerInstance::BeginEviction(std::unique_lock<std::mutex> *lock, const EvictedPage &evicted) {
+  if (evicted.page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  // The background writer may still be writing an older copy of the victim.
+  if (evicted.write_back_) {
+    io_cv_.wait(*lock, [&] { return bg_writing_pages_.count(evicted.page_id_) == 0; });
+  }
+  evicting_pages_.insert(evicted.page_id_);
+}
+
+void BufferPoolManagerInstance::CompressEvictedPage(const EvictedPage &evicted, const char *data) {
+  // The frame is locked or marked as having I/O, so the page does not change while it is compressed.
+  if (evicted.compress_) {
+    compressed_cache_->Put(evicted.page_id_, data);
+  }
+}
+
+Page *BufferPoolManagerInstance::InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                                             page_id_t page_id, const EvictedPage &evicted, bool read_from_disk) {
+  Page *page = &pages_[frame_id];
+  bool needs_io = evicted.page_id_ != INVALID_PAGE_ID || read_from_disk;
+  if (!needs_io) {
+    page->ResetMemory();
+  }
+
+  // Publish the page. Threads that find it before its I/O is done wait for the I/O.
+  io_in_progress_[frame_id] = needs_io;
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  if (frame_rings_[frame_id] == nullptr) {
+    replacer_->RecordAccess(frame_id);
+  }
+  // A new page may reuse the id of a deleted page.
+  CompressedPageCache *cache = compressed_cache_.get();
+  if (cache != nullptr && !read_from_disk) {
+    cache->Erase(page_id);
+  }
+
+  if (!needs_io) {
+    return page;
+  }
+
+  // Run the compression and the disk I/O without the latch. Threads that want this page wait on the frame, threads
+  // that want the victim wait until it has been compressed and written back, and everybody else is not blocked at all.
+  BeginEviction(lock, evicted);
+  lock->unlock();
+
+  CompressEvictedPage(evicted, page->data_);
+  if (evicted.write_back_) {
+    disk_scheduler_->WritePage(evicted.page_id_, page->data_);
+    ++num_foreground_writes_;
+  }
+  if (read_from_disk && (cache == nullptr || !cache->Take(page_id, page->data_))) {
+    disk_scheduler_->ReadPage(page_id, page->data_);
+  } else if (!read_from_disk) {
+    page->ResetMemory();
+  }
+
+  lock->lock();
+  evicting_pages_.erase(evicted.page_id_);
+  io_in_progress_[frame_id] = false;
+  io_cv_.notify_all();
+  return page;
+}
+
+bool BufferPoolManagerInstance::TryPinResident(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  // Frames that go away while the pool shrinks are only pinned with the latch, so that Resize can empty them.
+  if (static_cast<size_t>(frame_id) >= pool_size_) {
+    return false;
+  }
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // The frame may have been reused for another page since the lookup, the page may still be read in, or the pool may
+  // have shrunk. A page in a ring that is used normally has to leave its ring, which needs the latch.
+  if (page->page_id_ != page_id || io_in_progress_[frame_id] || static_cast<size_t>(frame_id) >= pool_size_ ||
+      (access_type == AccessType::Normal && frame_rings_[frame_id] != nullptr)) {
+    UnpinFrame(frame_id, false);
+    return false;
+  }
+
+  if (pin_count == 0) {
+    replacer_->Pin(frame_id);
+  }
+  if (access_type == AccessType::Normal) {
+    replacer_->RecordAccess(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id, bool is_dirty) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+    // Set the flag before the pin is released, so that whoever reuses the frame sees it.
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+
+  // A pin taken concurrently may already have removed the frame from the replacer again, which is harmless: a frame
+  // is only reused after LockFrame. Ring frames are recycled by their ring, and a prefetched frame is handed to the
+  // replacer by FinishUnpinnedIo once its read is done.
+  if (pin_count == 1 && frame_rings_[frame_id] == nullptr && !io_in_progress_[frame_id]) {
+    replacer_->Unpin(frame_id);
+  }
+  // Resize waits for the last pin on a frame that goes away. It looks at the pin count with the latch held, so taking
+  // the latch before signalling makes sure that the signal is not lost.
+  if (pin_count == 1 && static_cast<size_t>(frame_id) >= pool_size_) {
+    std::lock_guard<std::mutex> guard(latch_);
+    io_cv_.notify_all();
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::FinishUnpinnedIo(frame_id_t frame_id) {
+  // UnpinFrame releases the pin before it looks at the flag, and this clears the flag before it looks at the pin
+  // count, so whichever of both comes last sees the other and the frame always reaches the replacer. A frame that both
+  // hand over is simply unpinned twice. Pins taken without the latch while the read was running may be released at
+  // any point of this.
+  io_in_progress_[frame_id] = false;
+  if (pages_[frame_id].pin_count_ == 0 && frame_rings_[frame_id] == nullptr) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::LockFrame(frame_id_t frame_id) {
+  int pin_count = 0;
+  return !io_in_progress_[frame_id] && pages_[frame_id].pin_count_.compare_exchange_strong(pin_count, FRAME_LOCKED);
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  size_t max_prefetches = std::max<size_t>(1, pool_size_ / 4);
+  FrameRing *ring = GetRing(access_type);
+  size_t num_queued = 0;
+  for (auto page_id : page_ids) {
+    if (num_prefetches_in_flight_ >= max_prefetches) {
+      break;
+    }
+    if (page_id == INVALID_PAGE_ID || page_table_.Contains(page_id) || evicting_pages_.count(page_id) > 0 ||
+        bg_writing_pages_.count(page_id) > 0) {
+      continue;
+    }
+
+    frame_id_t frame_id;
+    EvictedPage evicted;
+    if (ring != nullptr ? !FindRingFrame(ring, &frame_id, &evicted) : !FindFreeFrame(&frame_id, &evicted)) {
+      break;
+    }
+
+    // The frame stays unpinned and out of the replacer until the read is done. FetchPage waits for the I/O like for
+    // any other page that is being read in.
+    Page *page = &pages_[frame_id];
+    io_in_progress_[frame_id] = true;
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page->pin_count_ = 0;
+    page_table_.Insert(page_id, frame_id);
+    BeginEviction(&lock, evicted);
+    prefetch_queue_.push_back({frame_id, page_id, evicted});
+    ++num_prefetches_in_flight_;
+    ++num_queued;
+  }
+
+  if (num_queued == 0) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    enable_prefetcher_ = true;
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+bool BufferPoolManagerInstance::WaitForPrefetch(std::unique_lock<std::mutex> *lock) {
+  if (num_prefetches_in_flight_ == 0) {
+    return false;
+  }
+  io_cv_.wait(*lock);
+  return true;
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return !prefetch_queue_.empty() || !enable_prefetcher_; });
+    // Queued frames are in the page table, so the queue is always drained before the thread exits.
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // Take every queued prefetch, so that all their I/Os are outstanding at once.
+    std::vector<PrefetchRequest> requests(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    CompressedPageCache *cache = compressed_cache_.get();
+    lock.unlock();
+
+    // The victims are compressed and written back first, since their pages are read into the same frames.
+    std::vector<DiskRequest> writes;
+    std::vector<std::future<bool>> write_futures;
+    for (auto &request : requests) {
+      CompressEvictedPage(request.evicted_, pages_[request.frame_id_].data_);
+      if (request.evicted_.write_back_) {
+        auto promise = disk_scheduler_->CreatePromise();
+        write_futures.push_back(promise.get_future());
+        writes.push_back({true, pages_[request.frame_id_].data_, request.evicted_.page_id_, std::move(promise)});
+      }
+    }
+    disk_scheduler_->Schedule(std::move(writes));
+    for (auto &future : write_futures) {
+      future.get();
+    }
+    num_foreground_writes_ += write_futures.size();
+
+    std::vector<DiskRequest> reads;
+    std::vector<std::future<bool>> read_futures(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      Page *page = &pages_[requests[i].frame_id_];
+      if (cache == nullptr || !cache->Take(requests[i].page_id_, page->data_)) {
+        auto promise = disk_scheduler_->CreatePromise();
+        read_futures[i] = promise.get_future();
+        reads.push_back({false, page->data_, requests[i].page_id_, std::move(promise)});
+      }
+    }
+    disk_scheduler_->Schedule(std::move(reads));
+
+    // Hand out each page as soon as its read is done.
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (read_futures[i].valid()) {
+        read_futures[i].get();
+      }
+      const PrefetchRequest &request = requests[i];
+      lock.lock();
+      evicting_pages_.erase(request.evicted_.page_id_);
+      --num_prefetches_in_flight_;
+      FinishUnpinnedIo(request.frame_id_);
+      io_cv_.notify_all();
+      lock.unlock();
+    }
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::StartBackgroundWriter(double dirty_ratio, size_t max_pages) {
+  if (bg_writer_thread_ != nullptr) {
+    return;
+  }
+  enable_bg_writer_ = true;
+  bg_writer_thread_ = new std::thread(&BufferPoolManagerInstance::RunBackgroundWriter, this, dirty_ratio, max_pages);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  if (bg_writer_thread_ == nullptr) {
+    return;
+  }
+  enable_bg_writer_ = false;
+  bg_writer_thread_->join();
+  delete bg_writer_thread_;
+  bg_writer_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(double dirty_ratio, size_t max_pages) {
+  // Every round writes from the same staging buffer.
+  max_pages = std::min(max_pages, max_pool_size_);
+  DiskManager::AlignedBuffer copies = DiskManager::AllocateAligned(max_pages * PAGE_SIZE);
+  while (enable_bg_writer_) {
+    std::this_thread::sleep_for(bg_writer_interval);
+    WriteBackDirtyPages(dirty_ratio, max_pages, copies.get());
+  }
+}
+
+size_t BufferPoolManagerInstance::WriteBackDirtyPages(double dirty_ratio, size_t max_pages) {
+  max_pages = std::min(max_pages, max_pool_size_);
+  DiskManager::AlignedBuffer copies = DiskManager::AllocateAligned(max_pages * PAGE_SIZE);
+  return WriteBackDirtyPages(dirty_ratio, max_pages, copies.get());
+}
+
+size_t BufferPoolManagerInstance::WriteBackDirtyPages(double dirty_ratio, size_t max_pages, char *copies) {
+  std::unique_lock<std::mutex> lock(latch_);
+  std::vector<page_id_t> page_ids;
+
+  // Clean the pages the replacer is about to evict first.
+  for (auto frame_id : replacer_->PeekVictims(max_pages)) {
+    page_id_t page_id;
+    if (CopyForWriteBack(frame_id, copies + page_ids.size() * PAGE_SIZE, &page_id)) {
+      page_ids.push_back(page_id);
+    }
+  }
+
+  // While too much of the pool is dirty, clean any other page too, continuing where the last round stopped. Frames
+  // from pool_size_ on are emptied by Resize.
+  size_t pool_size = pool_size_;
+  auto max_dirty = static_cast<size_t>(dirty_ratio * pool_size);
+  auto num_dirty = static_cast<size_t>(
+      std::count_if(pages_, pages_ + pool_size, [](const Page &page) { return page.is_dirty_.load(); }));
+  for (size_t i = 0; i < pool_size && page_ids.size() < max_pages && num_dirty > max_dirty; ++i) {
+    auto frame_id = static_cast<frame_id_t>(bg_writer_cursor_ % pool_size);
+    bg_writer_cursor_ = (frame_id + 1) % pool_size;
+    page_id_t page_id;
+    if (CopyForWriteBack(frame_id, copies + page_ids.size() * PAGE_SIZE, &page_id)) {
+      page_ids.push_back(page_id);
+      --num_dirty;
+    }
+  }
+  if (page_ids.empty()) {
+    return 0;
+  }
+
+  // Write all copies at once with the latch released.
+  lock.unlock();
+  std::vector<DiskRequest> writes;
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    auto promise = disk_scheduler_->CreatePromise();
+    futures.push_back(promise.get_future());
+    writes.push_back({true, copies + i * PAGE_SIZE, page_ids[i], std::move(promise)});
+  }
+  disk_scheduler_->Schedule(std::move(writes));
+  for (auto &future : futures) {
+    future.get();
+  }
+  num_background_writes_ += page_ids.size();
+
+  lock.lock();
+  for (auto page_id : page_ids) {
+    bg_writing_pages_.erase(page_id);
+  }
+  io_cv_.notify_all();
+  return page_ids.size();
+}
+
+bool BufferPoolManagerInstance::CopyForWriteBack(frame_id_t frame_id, char *copy, page_id_t *page_id) {
+  Page *page = &pages_[frame_id];
+  if (!page->is_dirty_ || bg_writing_pages_.count(page->page_id_) > 0) {
+    return false;
+  }
+  // WAL: a page may only reach the disk after the log records that changed it.
+  if (enable_logging && log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN()) {
+    return false;
+  }
+  // Keep lock-free pins out while the copy is taken.
+  if (!LockFrame(frame_id)) {
+    return false;
+  }
+
+  // Nobody can change an unpinned page, but its frame may be reused as soon as the latch is released, so write a copy.
+  // Until the copy is on disk, the page is not read back in and newer versions of it are not written.
+  *page_id = page->page_id_;
+  memcpy(copy, page->data_, PAGE_SIZE);
+  page->is_dirty_ = false;
+  page->pin_count_ = 0;
+  bg_writing_pages_.insert(*page_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::Resize(size_t new_pool_size) {
+  if (new_pool_size == 0 || new_pool_size > max_pool_size_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  size_t old_pool_size = pool_size_;
+  if (new_pool_size >= old_pool_size) {
+    for (size_t i = old_pool_size; i < new_pool_size; ++i) {
+      if (i == num_frames_) {
+        new (&pages_[i]) Page(frame_arena_.GetFrame(static_cast<frame_id_t>(i)));
+        pages_[i].pin_count_ = FRAME_LOCKED;
+        ++num_frames_;
+      }
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = new_pool_size;
+    SetRingCapacities();
+    return true;
+  }
+
+  // Stop handing out the frames that go away, then empty them as their pages are unpinned. Pins taken meanwhile are
+  // fine, the frame is emptied once they are released.
+  pool_size_ = new_pool_size;
+  SetRingCapacities();
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_pool_size; });
+  std::vector<frame_id_t> retiring;
+  for (size_t i = new_pool_size; i < old_pool_size; ++i) {
+    retiring.push_back(static_cast<frame_id_t>(i));
+  }
+  while (!retiring.empty()) {
+    std::vector<frame_id_t> pinned;
+    for (auto frame_id : retiring) {
+      Page *page = &pages_[frame_id];
+      // Free frames and frames emptied by DeletePage are done already.
+      if (page->page_id_ == INVALID_PAGE_ID && page->pin_count_ == FRAME_LOCKED) {
+        continue;
+      }
+      if (LockFrame(frame_id)) {
+        RetireFrame(&lock, frame_id);
+      } else {
+        pinned.push_back(frame_id);
+      }
+    }
+    retiring.swap(pinned);
+    // The last unpin of a frame that goes away, the end of its I/O, and DeletePage all signal.
+    if (!retiring.empty()) {
+      io_cv_.wait(lock);
+    }
+  }
+
+  frame_arena_.Release(static_cast<frame_id_t>(new_pool_size), old_pool_size - new_pool_size);
+  return true;
+}
+
+void BufferPoolManagerInstance::RetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  EvictedPage evicted;
+  evicted.write_back_ = page->is_dirty_;
+  evicted.compress_ = compressed_cache_ != nullptr && frame_rings_[frame_id] == nullptr;
+  if (evicted.write_back_ || evicted.compress_) {
+    evicted.page_id_ = page_id;
+  }
+  if (frame_rings_[frame_id] != nullptr) {
+    RemoveFromRing(frame_id);
+  }
+  replacer_->Remove(frame_id);
+  page_table_.Erase(page_id);
+
+  if (evicted.page_id_ != INVALID_PAGE_ID) {
+    // Same as evicting a victim, except that no other page is read into the frame.
+    BeginEviction(lock, evicted);
+    io_in_progress_[frame_id] = true;
+    lock->unlock();
+    CompressEvictedPage(evicted, page->data_);
+    if (evicted.write_back_) {
+      disk_manager_->WritePage(page_id, page->data_);
+      ++num_foreground_writes_;
+    }
+    lock->lock();
+    evicting_pages_.erase(page_id);
+    io_in_progress_[frame_id] = false;
+    io_cv_.notify_all();
+  }
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::SetRingCapacities() {
+  // Rings are kept small relative to the pool so that scans never take over more than a fraction of it.
+  scan_ring_.capacity_ = std::min<size_t>(SEQ_SCAN_RING_SIZE, std::max<size_t>(1, pool_size_ / 4));
+  bulk_write_ring_.capacity_ = std::min<size_t>(BULK_WRITE_RING_SIZE, std::max<size_t>(1, pool_size_ / 4));
+  for (FrameRing *ring : {&scan_ring_, &bulk_write_ring_}) {
+    while (ring->frames_.size() > ring->capacity_) {
+      frame_id_t frame_id = ring->frames_[ring->next_];
+      RemoveFromRing(frame_id);
+      if (pages_[frame_id].pin_count_ == 0 && !io_in_progress_[frame_id]) {
+        replacer_->Unpin(frame_id);
+      }
+    }
+  }
+}
+
+void BufferPoolManagerInstance::EnableCompressedCache(size_t capacity) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->SetCapacity(capacity);
+    return;
+  }
+  compressed_cache_ = std::make_unique<CompressedPageCache>(capacity);
+}
+
+CompressedCacheStats BufferPoolManagerInstance::GetCompressedCacheStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return compressed_cache_ != nullptr ? compressed_cache_->GetStats() : CompressedCacheStats{};
+}
+
+void BufferPoolManagerInstance::SaveResidentPages(const std::string &file_name) {
+  WritePageList(file_name, GetResidentPages());
+}
+
+void BufferPoolManagerInstance::WarmUp(const std::string &file_name) {
+  std::vector<page_id_t> page_ids;
+  for (auto page_id : ReadPageList(file_name)) {
+    if (page_id != INVALID_PAGE_ID && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+      page_ids.push_back(page_id);
+    }
+  }
+  StartWarmUp(std::move(page_ids));
+}
+
+void BufferPoolManagerInstance::WaitForWarmUp() {
+  if (warmup_thread_ != nullptr) {
+    warmup_thread_->join();
+    delete warmup_thread_;
+    warmup_thread_ = nullptr;
+  }
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::GetResidentPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  std::vector<page_id_t> page_ids;
+  auto is_cached = [&](frame_id_t frame_id) {
+    return static_cast<size_t>(frame_id) < num_frames_ && pages_[frame_id].page_id_ != INVALID_PAGE_ID &&
+           !io_in_progress_[frame_id] && frame_rings_[frame_id] == nullptr;
+  };
+  // Pinned pages are in use right now, so they come first.
+  for (size_t i = 0; i < num_frames_; ++i) {
+    if (is_cached(static_cast<frame_id_t>(i)) && pages_[i].pin_count_ > 0) {
+      page_ids.push_back(pages_[i].page_id_);
+    }
+  }
+  // The replacer lists the others in the order it would evict them.
+  auto victims = replacer_->PeekVictims(max_pool_size_);
+  for (auto iter = victims.rbegin(); iter != victims.rend(); ++iter) {
+    if (is_cached(*iter) && pages_[*iter].pin_count_ == 0) {
+      page_ids.push_back(pages_[*iter].page_id_);
+    }
+  }
+  return page_ids;
+}
+
+void BufferPoolManagerInstance::StartWarmUp(std::vector<page_id_t> page_ids) {
+  StopWarmUp();
+  enable_warmup_ = true;
+  warmup_thread_ = new std::thread(&BufferPoolManagerInstance::RunWarmUp, this, std::move(page_ids));
+}
+
+void BufferPoolManagerInstance::StopWarmUp() {
+  enable_warmup_ = false;
+  WaitForWarmUp();
+}
+
+void BufferPoolManagerInstance::RunWarmUp(std::vector<page_id_t> page_ids) {
+  // A warmup never evicts anything, so only the most recently used pages that fit in the free frames are loaded.
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    page_ids.resize(std::min(page_ids.size(), free_list_.size()));
+  }
+  // Read them in page id order, so that neighbouring pages are read together.
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  DiskManager::AlignedBuffer buffer = DiskManager::AllocateAligned(WARMUP_READ_PAGES * PAGE_SIZE);
+  size_t begin = 0;
+  bool out_of_frames = false;
+  while (begin < page_ids.size() && enable_warmup_ && !out_of_frames) {
+    // A run is a range of pages of this instance with no page missing, read from disk at once. In a parallel buffer
+    // pool, the pages of the other instances within the range are read too and dropped.
+    size_t end = begin + 1;
+    while (end < page_ids.size() && page_ids[end] - page_ids[end - 1] == static_cast<page_id_t>(num_instances_) &&
+           page_ids[end] - page_ids[begin] < WARMUP_READ_PAGES) {
+      ++end;
+    }
+
+    // Reserve free frames the same way PrefetchPages does. Pages that were fetched meanwhile are skipped.
+    std::vector<std::pair<page_id_t, frame_id_t>> reserved;
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      for (size_t i = begin; i < end; ++i) {
+        page_id_t page_id = page_ids[i];
+        if (page_table_.Contains(page_id) || evicting_pages_.count(page_id) > 0 ||
+            bg_writing_pages_.count(page_id) > 0) {
+          continue;
+        }
+        if (free_list_.empty()) {
+          out_of_frames = true;
+          break;
+        }
+        frame_id_t frame_id = free_list_.front();
+        free_list_.pop_front();
+        Page *page = &pages_[frame_id];
+        io_in_progress_[frame_id] = true;
+        page->page_id_ = page_id;
+        page->is_dirty_ = false;
+        page->pin_count_ = 0;
+        page_table_.Insert(page_id, frame_id);
+        reserved.emplace_back(page_id, frame_id);
+      }
+    }
+    begin = end;
+    if (reserved.empty()) {
+      continue;
+    }
+
+    page_id_t first_page_id = reserved.front().first;
+    disk_manager_->ReadPages(first_page_id, reserved.back().first - first_page_id + 1, buffer.get());
+    for (auto &[page_id, frame_id] : reserved) {
+      memcpy(pages_[frame_id].data_, buffer.get() + static_cast<size_t>(page_id - first_page_id) * PAGE_SIZE,
+             PAGE_SIZE);
+    }
+
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &[page_id, frame_id] : reserved) {
+      // The disk has the same content as a compressed copy, which must go now that the page is resident.
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Erase(page_id);
+      }
+      FinishUnpinnedIo(frame_id);
+    }
+    num_warmed_pages_ += reserved.size();
+    io_cv_.notify_all();
+  }
+}
+
+void BufferPoolManagerInstance::WritePageList(const std::string &file_name, const std::vector<page_id_t> &page_ids) {
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  uint32_t magic = PAGE_LIST_MAGIC;
+  auto num_pages = static_cast<uint32_t>(page_ids.size());
+  out.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+  out.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), num_pages * sizeof(page_id_t));
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::ReadPageList(const std::string &file_name) {
+  std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+  auto file_size = static_cast<size_t>(std::max<std::streamoff>(in.tellg(), 0));
+  in.seekg(0);
+  uint32_t magic = 0;
+  uint32_t num_pages = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages));
+  if (!in || magic != PAGE_LIST_MAGIC ||
+      file_size != sizeof(magic) + sizeof(num_pages) + static_cast<size_t>(num_pages) * sizeof(page_id_t)) {
+    return {};
+  }
+  std::vector<page_id_t> page_ids(num_pages);
+  in.read(reinterpret_cast<char *>(page_ids.data()), num_pages * sizeof(page_id_t));
+  if (!in) {
+    return {};
+  }
+  return page_ids;
+}
+
+BufferPoolManagerInstance::FrameRing *BufferPoolManagerInstance::GetRing(AccessType access_type) {
+  switch (access_type) {
+    case AccessType::SequentialScan:
+      return &scan_ring_;
+    case AccessType::BulkWrite:
+      return &bulk_write_ring_;
+    case AccessType::Normal:
+    default:
+      return nullptr;
+  }
+}
+
+bool BufferPoolManagerInstance::FindRingFrame(FrameRing *ring, frame_id_t *frame_id, EvictedPage *evicted) {
+  if (ring->frames_.size() >= ring->capacity_) {
+    frame_id_t candidate = ring->frames_[ring->next_];
+    Page *page = &pages_[candidate];
+    if (static_cast<size_t>(candidate) < pool_size_ && LockFrame(candidate)) {
+      ring->next_ = (ring->next_ + 1) % ring->frames_.size();
+      *frame_id = candidate;
+      // Pages of a ring are not worth keeping, so they skip the compressed cache.
+      *evicted = EvictedPage{};
+      if (page->is_dirty_) {
+        *evicted = {page->page_id_, true, false};
+      }
+      page_table_.Erase(page->page_id_);
+      return true;
+    }
+    // Someone else is using the page, so it stays resident and becomes an ordinary page once it is unpinned. The
+    // unpin may already have happened, in which case the frame goes to the replacer here.
+    RemoveFromRing(candidate);
+    if (page->pin_count_ == 0 && !io_in_progress_[candidate]) {
+      replacer_->Unpin(candidate);
+    }
+  }
+
+  if (!FindFreeFrame(frame_id, evicted)) {
+    return false;
+  }
+  ring->frames_.insert(ring->frames_.begin() + ring->next_, *frame_id);
+  ring->next_ = (ring->next_ + 1) % ring->frames_.size();
+  frame_rings_[*frame_id] = ring;
+  return true;
+}
+
+void BufferPoolManagerInstance::RemoveFromRing(frame_id_t frame_id) {
+  FrameRing *ring = frame_rings_[frame_id];
+  auto iter = std::find(ring->frames_.begin(), ring->frames_.end(), frame_id);
+  auto pos = static_cast<size_t>(iter - ring->frames_.begin());
+  ring->frames_.erase(iter);
+  if (pos < ring->next_) {
+    --ring->next_;
+  }
+  if (ring->next_ >= ring->frames_.size()) {
+    ring->next_ = 0;
+  }
+  frame_rings_[frame_id] = nullptr;
+}
+
+}  // namespace bustub
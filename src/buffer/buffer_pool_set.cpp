@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set.cpp
+//
+// Identification: src/buffer/buffer_pool_set.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_set.h"
+
+#include <stdexcept>
+
+namespace bustub {
+
+BufferPoolManagerInstance *BufferPoolSet::AddPool(const std::string &name, size_t pool_size,
+                                                  ReplacerType replacer_type, size_t max_pool_size,
+                                                  size_t correlated_window) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(pools_.count(name) == 0, "Pool names should be unique!");
+  auto &pool = pools_[name];
+  pool = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager_, log_manager_, replacer_type,
+                                                     max_pool_size, correlated_window);
+  return pool.get();
+}
+
+BufferPoolManagerInstance *BufferPoolSet::GetPool(const std::string &name) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto iter = pools_.find(name);
+  if (iter == pools_.end()) {
+    throw std::out_of_range("The buffer pool does not exist!");
+  }
+  return iter->second.get();
+}
+
+bool BufferPoolSet::HasPool(const std::string &name) {
+  std::lock_guard<std::mutex> guard(latch_);
+  return pools_.count(name) > 0;
+}
+
+std::vector<std::string> BufferPoolSet::GetPoolNames() {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<std::string> names;
+  for (auto &[name, pool] : pools_) {
+    names.push_back(name);
+  }
+  return names;
+}
+
+size_t BufferPoolSet::GetTotalPoolSize() {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t total = 0;
+  for (auto &[name, pool] : pools_) {
+    total += pool->GetPoolSize();
+  }
+  return total;
+}
+
+bool BufferPoolSet::ResizePool(const std::string &name, size_t new_pool_size) {
+  return GetPool(name)->Resize(new_pool_size);
+}
+
+BufferPoolStats BufferPoolSet::GetStats(const std::string &name) {
+  BufferPoolManagerInstance *pool = GetPool(name);
+  BufferPoolStats stats;
+  stats.pool_size_ = pool->GetPoolSize();
+  stats.num_misses_ = pool->GetNumMisses();
+  stats.num_foreground_writes_ = pool->GetNumForegroundWrites();
+  stats.num_background_writes_ = pool->GetNumBackgroundWrites();
+  stats.compressed_cache_ = pool->GetCompressedCacheStats();
+  return stats;
+}
+
+void BufferPoolSet::FlushAllPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto &[name, pool] : pools_) {
+    pool->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
@@ -14,16 +14,91 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  if (size_.load() == 0) {
+    return false;
+  }
+  // Concurrent Pin/Unpin can keep clearing and setting bits behind the hand, so no fixed number of moves is enough.
+  // Give up only once the hand has passed every frame in a row without finding one in the replacer.
+  size_t num_skipped = 0;
+  while (num_skipped < num_pages_) {
+    size_t frame = hand_.fetch_add(1) % num_pages_;
+    uint8_t state = states_[frame].load();
+    if ((state & EVICTABLE) == 0) {
+      ++num_skipped;
+      continue;
+    }
+    num_skipped = 0;
+    if ((state & REFERENCED) != 0) {
+      // Give the frame a second chance. Losing the race to a concurrent Pin/Unpin is fine, the hand just moves on.
+      states_[frame].compare_exchange_strong(state, state & ~REFERENCED);
+      continue;
+    }
+    if (states_[frame].compare_exchange_strong(state, 0)) {
+      --size_;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].fetch_and(~EVICTABLE);
+  if ((old_state & EVICTABLE) != 0) {
+    --size_;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].fetch_or(EVICTABLE | REFERENCED);
+  if ((old_state & EVICTABLE) == 0) {
+    ++size_;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id) { states_[frame_id].fetch_or(REFERENCED); }
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].exchange(0);
+  if ((old_state & EVICTABLE) != 0) {
+    --size_;
+  }
+}
+
+std::vector<frame_id_t> ClockReplacer::PeekVictims(size_t max_frames) {
+  // Walk one sweep from the hand. Unreferenced frames go in the order the hand reaches them, referenced ones only
+  // after the hand has come round again.
+  std::vector<frame_id_t> victims;
+  std::vector<frame_id_t> referenced;
+  size_t hand = hand_.load();
+  for (size_t i = 0; i < num_pages_ && victims.size() < max_frames; ++i) {
+    size_t frame = (hand + i) % num_pages_;
+    uint8_t state = states_[frame].load();
+    if ((state & EVICTABLE) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      referenced.push_back(static_cast<frame_id_t>(frame));
+    } else {
+      victims.push_back(static_cast<frame_id_t>(frame));
+    }
+  }
+  for (size_t i = 0; i < referenced.size() && victims.size() < max_frames; ++i) {
+    victims.push_back(referenced[i]);
+  }
+  return victims;
+}
+
+size_t ClockReplacer::Size() { return size_.load(); }
 
 }  // namespace bustub
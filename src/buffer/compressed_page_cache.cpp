@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <utility>
+
+#include "buffer/page_codec.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+void CompressedPageCache::Put(page_id_t page_id, const char *data) {
+  // Compress before taking the latch. A page that does not get smaller is kept as it is, which Take tells apart by its
+  // size.
+  char buffer[PAGE_SIZE];
+  size_t size = PageCodec::Compress(data, PAGE_SIZE, buffer, PAGE_SIZE - 1);
+  const char *stored = buffer;
+  if (size == 0) {
+    size = PAGE_SIZE;
+    stored = data;
+  }
+  std::unique_ptr<char[]> copy(new char[size]);
+  memcpy(copy.get(), stored, size);
+
+  std::lock_guard<std::mutex> guard(latch_);
+  ++stats_.num_puts_;
+  stats_.raw_bytes_ += PAGE_SIZE;
+  stats_.stored_bytes_ += size;
+
+  auto iter = entries_.find(page_id);
+  if (iter != entries_.end()) {
+    EraseEntry(iter);
+  }
+  if (size > capacity_) {
+    return;
+  }
+  lru_.push_front(page_id);
+  entries_.emplace(page_id, Entry{std::move(copy), size, lru_.begin()});
+  size_ += size;
+  EvictToCapacity();
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, char *data) {
+  std::unique_ptr<char[]> stored;
+  size_t size;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    ++stats_.num_lookups_;
+    auto iter = entries_.find(page_id);
+    if (iter == entries_.end()) {
+      return false;
+    }
+    ++stats_.num_hits_;
+    stored = std::move(iter->second.data_);
+    size = iter->second.size_;
+    EraseEntry(iter);
+  }
+
+  if (size == PAGE_SIZE) {
+    memcpy(data, stored.get(), PAGE_SIZE);
+  } else {
+    [[maybe_unused]] size_t page_size = PageCodec::Decompress(stored.get(), size, data, PAGE_SIZE);
+    BUSTUB_ASSERT(page_size == PAGE_SIZE, "Compressed page is corrupt");
+  }
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto iter = entries_.find(page_id);
+  if (iter != entries_.end()) {
+    EraseEntry(iter);
+  }
+}
+
+void CompressedPageCache::SetCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> guard(latch_);
+  capacity_ = capacity;
+  EvictToCapacity();
+}
+
+size_t CompressedPageCache::GetCapacity() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return capacity_;
+}
+
+size_t CompressedPageCache::GetSize() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return size_;
+}
+
+size_t CompressedPageCache::GetNumPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return entries_.size();
+}
+
+CompressedCacheStats CompressedPageCache::GetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
+void CompressedPageCache::EraseEntry(std::unordered_map<page_id_t, Entry>::iterator iter) {
+  size_ -= iter->second.size_;
+  lru_.erase(iter->second.lru_iter_);
+  entries_.erase(iter);
+}
+
+void CompressedPageCache::EvictToCapacity() {
+  while (size_ > capacity_) {
+    EraseEntry(entries_.find(lru_.back()));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames) {
+  size_t size = std::max<size_t>(num_frames, 1) * PAGE_SIZE;
+  if (size < HUGE_PAGE_SIZE) {
+    // Anonymous mappings are page-aligned already, and a small pool gains nothing from huge pages.
+    mapped_size_ = size;
+    void *data = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+    }
+    data_ = static_cast<char *>(data);
+    return;
+  }
+
+  // Round up to whole huge pages, and map one more so that the arena can start on a huge page boundary. The kernel
+  // only backs aligned 2 MB ranges with huge pages.
+  mapped_size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  void *data = mmap(nullptr, mapped_size_ + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  auto start = reinterpret_cast<uintptr_t>(data);
+  auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (aligned > start) {
+    munmap(data, aligned - start);
+  }
+  if (aligned + mapped_size_ < start + mapped_size_ + HUGE_PAGE_SIZE) {
+    munmap(reinterpret_cast<void *>(aligned + mapped_size_), start + HUGE_PAGE_SIZE - aligned);
+  }
+  data_ = reinterpret_cast<char *>(aligned);
+
+#ifdef MADV_HUGEPAGE
+  // Only a hint: without transparent huge pages the arena is simply backed by regular pages.
+  huge_page_advised_ = madvise(data_, mapped_size_, MADV_HUGEPAGE) == 0;
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, mapped_size_); }
+
+void FrameArena::Release(frame_id_t first_frame_id, size_t num_frames) {
+  if (num_frames > 0) {
+    madvise(GetFrame(first_frame_id), num_frames * PAGE_SIZE, MADV_DONTNEED);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k, size_t correlated_window)
+    : frames_(num_frames), k_(k), correlated_window_(correlated_window) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one access of history");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  std::vector<frame_id_t> victims = FindVictims(1);
+  if (victims.empty()) {
+    return false;
+  }
+  ResetFrame(victims[0]);
+  *frame_id = victims[0];
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  FrameInfo &info = frames_[frame_id];
+  if (info.in_use_ && info.evictable_) {
+    info.evictable_ = false;
+    evictable_.erase({GetEvictionKey(info), frame_id});
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  FrameInfo &info = frames_[frame_id];
+  info.in_use_ = true;
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    evictable_.emplace(GetEvictionKey(info), frame_id);
+  }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  FrameInfo &info = frames_[frame_id];
+  size_t now = ++current_timestamp_;
+  bool correlated = !info.history_.empty() && now - info.last_access_ < correlated_window_;
+  info.in_use_ = true;
+  info.last_access_ = now;
+  if (correlated) {
+    return;
+  }
+
+  // The key of an evictable frame changes with its history.
+  if (info.evictable_) {
+    evictable_.erase({GetEvictionKey(info), frame_id});
+  }
+  info.history_.push_back(now);
+  if (info.history_.size() > k_) {
+    info.history_.pop_front();
+  }
+  if (info.evictable_) {
+    evictable_.emplace(GetEvictionKey(info), frame_id);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  ResetFrame(frame_id);
+}
+
+std::vector<frame_id_t> LRUKReplacer::PeekVictims(size_t max_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  return FindVictims(max_frames);
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return evictable_.size();
+}
+
+LRUKReplacer::EvictionKey LRUKReplacer::GetEvictionKey(const FrameInfo &info) const {
+  // +inf backward k-distance wins over a finite one, and then the older timestamp wins: the oldest access for +inf,
+  // the k-th most recent access otherwise. Both are the front of the history.
+  bool finite = info.history_.size() >= k_;
+  size_t timestamp = info.history_.empty() ? 0 : info.history_.front();
+  return {finite, timestamp};
+}
+
+bool LRUKReplacer::IsCorrelated(const FrameInfo &info) const {
+  return !info.history_.empty() && current_timestamp_ - info.last_access_ < correlated_window_;
+}
+
+std::vector<frame_id_t> LRUKReplacer::FindVictims(size_t max_frames) const {
+  // Candidates outside their correlated reference window win over those inside it, which are only taken if there are
+  // not enough others.
+  std::vector<frame_id_t> victims;
+  std::vector<frame_id_t> correlated;
+  for (auto iter = evictable_.begin(); iter != evictable_.end() && victims.size() < max_frames; ++iter) {
+    if (IsCorrelated(frames_[iter->second])) {
+      correlated.push_back(iter->second);
+    } else {
+      victims.push_back(iter->second);
+    }
+  }
+  for (size_t i = 0; i < correlated.size() && victims.size() < max_frames; ++i) {
+    victims.push_back(correlated[i]);
+  }
+  return victims;
+}
+
+void LRUKReplacer::ResetFrame(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.in_use_ && info.evictable_) {
+    evictable_.erase({GetEvictionKey(info), frame_id});
+  }
+  info.history_.clear();
+  info.last_access_ = 0;
+  info.in_use_ = false;
+  info.evictable_ = false;
+}
+
+}  // namespace bustub
@@ -56,6 +56,16 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   latch_.unlock();
 }
 
+std::vector<frame_id_t> LRUReplacer::PeekVictims(size_t max_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  std::vector<frame_id_t> victims;
+  for (auto iter = lst_.rbegin(); iter != lst_.rend() && victims.size() < max_frames; ++iter) {
+    victims.push_back(*iter);
+  }
+  return victims;
+}
+
 size_t LRUReplacer::Size() { return mp_.size(); }
 
 }  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <sys/mman.h>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(DiskManager *disk_manager) {
+  data_ = disk_manager->MapDbFile(&mapped_size_);
+  num_pages_ = DiskManager::NumPagesIn(mapped_size_);
+  pages_ = std::make_unique<std::atomic<Page *>[]>(num_pages_);
+  for (size_t i = 0; i < num_pages_; ++i) {
+    pages_[i] = nullptr;
+  }
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    delete pages_[i].load();
+  }
+  DiskManager::UnmapDbFile(data_, mapped_size_);
+}
+
+Page *MmapBufferPoolManager::GetPage(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return nullptr;
+  }
+  Page *page = pages_[page_id].load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  // The Page never writes to its data, so casting away const is safe; callers that do write crash on the mapping.
+  auto *new_page = new Page(const_cast<char *>(data_) + DiskManager::PageOffset(page_id));
+  new_page->page_id_ = page_id;
+  if (pages_[page_id].compare_exchange_strong(page, new_page, std::memory_order_acq_rel)) {
+    return new_page;
+  }
+  // Another thread created the Page first.
+  delete new_page;
+  return page;
+}
+
+Page *MmapBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType access_type) {
+  Page *page = GetPage(page_id);
+  if (page != nullptr) {
+    ++page->pin_count_;
+  }
+  return page;
+}
+
+bool MmapBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  Page *page = GetPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (is_dirty) {
+    LOG_WARN("page %d was modified in a read-only buffer pool", page_id);
+    return false;
+  }
+  return true;
+}
+
+bool MmapBufferPoolManager::FlushPageImpl(page_id_t page_id) { return GetPage(page_id) != nullptr; }
+
+Page *MmapBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePageImpl(page_id_t page_id) { return false; }
+
+void MmapBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  for (auto page_id : page_ids) {
+    if (page_id >= 0 && static_cast<size_t>(page_id) < num_pages_) {
+      madvise(const_cast<char *>(data_) + DiskManager::PageOffset(page_id), PAGE_SIZE, MADV_WILLNEED);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/buffer/page_codec.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+uint32_t Read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/** Appends a length that did not fit in its nibble. */
+bool WriteLength(size_t length, uint8_t *out, size_t capacity, size_t *op) {
+  while (length >= 255) {
+    if (*op >= capacity) {
+      return false;
+    }
+    out[(*op)++] = 255;
+    length -= 255;
+  }
+  if (*op >= capacity) {
+    return false;
+  }
+  out[(*op)++] = static_cast<uint8_t>(length);
+  return true;
+}
+
+/** Reads a length that did not fit in its nibble. */
+bool ReadLength(const uint8_t *in, size_t size, size_t *ip, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= size) {
+      return false;
+    }
+    byte = in[(*ip)++];
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t PageCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  size_t op = 0;
+
+  // Emits the literals in [anchor, anchor + num_literals) and, if match_length is not 0, a match.
+  auto emit = [&](size_t anchor, size_t num_literals, size_t offset, size_t match_length) {
+    if (op >= capacity) {
+      return false;
+    }
+    size_t token_pos = op++;
+    uint8_t token = static_cast<uint8_t>(std::min<size_t>(num_literals, 15) << 4);
+    if (num_literals >= 15 && !WriteLength(num_literals - 15, out, capacity, &op)) {
+      return false;
+    }
+    if (op + num_literals > capacity) {
+      return false;
+    }
+    memcpy(out + op, in + anchor, num_literals);
+    op += num_literals;
+    if (match_length > 0) {
+      size_t length_code = match_length - MIN_MATCH;
+      token |= static_cast<uint8_t>(std::min<size_t>(length_code, 15));
+      if (op + 2 > capacity) {
+        return false;
+      }
+      out[op++] = static_cast<uint8_t>(offset & 0xFF);
+      out[op++] = static_cast<uint8_t>(offset >> 8);
+      if (length_code >= 15 && !WriteLength(length_code - 15, out, capacity, &op)) {
+        return false;
+      }
+    }
+    out[token_pos] = token;
+    return true;
+  };
+
+  // Most recent position of every hashed 4-byte sequence, -1 if none.
+  std::array<int32_t, 1 << HASH_BITS> table;
+  table.fill(-1);
+  size_t anchor = 0;
+  size_t ip = 0;
+  while (ip + MIN_MATCH <= size) {
+    uint32_t sequence = Read32(in + ip);
+    uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+    int32_t candidate = table[hash];
+    table[hash] = static_cast<int32_t>(ip);
+    if (candidate < 0 || ip - candidate > MAX_OFFSET || Read32(in + candidate) != sequence) {
+      ++ip;
+      continue;
+    }
+
+    size_t match_length = MIN_MATCH;
+    while (ip + match_length < size && in[candidate + match_length] == in[ip + match_length]) {
+      ++match_length;
+    }
+    if (!emit(anchor, ip - anchor, ip - candidate, match_length)) {
+      return 0;
+    }
+    ip += match_length;
+    anchor = ip;
+  }
+  if (!emit(anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return op;
+}
+
+size_t PageCodec::Decompress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < size) {
+    uint8_t token = in[ip++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(in, size, &ip, &num_literals)) {
+      return 0;
+    }
+    if (ip + num_literals > size || op + num_literals > capacity) {
+      return 0;
+    }
+    memcpy(out + op, in + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == size) {
+      // The last sequence has no match.
+      break;
+    }
+
+    if (ip + 2 > size) {
+      return 0;
+    }
+    size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+    ip += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && !ReadLength(in, size, &ip, &match_length)) {
+      return 0;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_length > capacity) {
+      return 0;
+    }
+    // Byte by byte, because the match may overlap the bytes it produces.
+    for (size_t i = 0; i < match_length; ++i, ++op) {
+      out[op] = out[op - offset];
+    }
+  }
+  return op;
+}
+
+}  // namespace bustub
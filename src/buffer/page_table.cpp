@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t capacity) {
+  // Keep the table at most half full. A power of two turns the modulo into a mask.
+  num_buckets_ = 1;
+  while (num_buckets_ * SLOTS_PER_BUCKET < 2 * capacity) {
+    num_buckets_ *= 2;
+  }
+  buckets_.reset(new Bucket[num_buckets_]);
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    for (auto &slot : buckets_[i].slots_) {
+      slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+    buckets_[i].overflow_.store(0, std::memory_order_relaxed);
+  }
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t bucket_index = HomeBucket(page_id);
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    const Bucket &bucket = buckets_[bucket_index];
+    for (const auto &slot : bucket.slots_) {
+      uint64_t value = slot.load(std::memory_order_acquire);
+      if (value != EMPTY_SLOT && GetPageId(value) == page_id) {
+        *frame_id = GetFrameId(value);
+        return true;
+      }
+    }
+    if (bucket.overflow_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    bucket_index = (bucket_index + 1) & (num_buckets_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id >= 0, "Only valid page ids can be inserted");
+  size_t bucket_index = HomeBucket(page_id);
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    Bucket &bucket = buckets_[bucket_index];
+    for (auto &slot : bucket.slots_) {
+      if (slot.load(std::memory_order_relaxed) == EMPTY_SLOT) {
+        slot.store(Pack(page_id, frame_id), std::memory_order_release);
+        ++size_;
+        return;
+      }
+    }
+    // Readers must not stop here before the entry is visible further on, so count it first.
+    bucket.overflow_.fetch_add(1, std::memory_order_release);
+    bucket_index = (bucket_index + 1) & (num_buckets_ - 1);
+  }
+  UNREACHABLE("page table is full");
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  size_t home = HomeBucket(page_id);
+  size_t bucket_index = home;
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    Bucket &bucket = buckets_[bucket_index];
+    for (auto &slot : bucket.slots_) {
+      uint64_t value = slot.load(std::memory_order_relaxed);
+      if (value != EMPTY_SLOT && GetPageId(value) == page_id) {
+        slot.store(EMPTY_SLOT, std::memory_order_release);
+        --size_;
+        // The entry is gone, so the buckets it skipped no longer need to send readers further.
+        for (size_t j = home; j != bucket_index; j = (j + 1) & (num_buckets_ - 1)) {
+          buckets_[j].overflow_.fetch_sub(1, std::memory_order_release);
+        }
+        return true;
+      }
+    }
+    if (bucket.overflow_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    bucket_index = (bucket_index + 1) & (num_buckets_ - 1);
+  }
+  return false;
+}
+
+size_t PageTable::HomeBucket(page_id_t page_id) const {
+  // Fibonacci hashing spreads consecutive page ids over the buckets.
+  uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash >> 32) & (num_buckets_ - 1);
+}
+
+}  // namespace bustub
@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size, size_t correlated_window)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.emplace_back(
+        new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager, replacer_type,
+                                      max_pool_size, correlated_window));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t new_pool_size) {
+  size_t num_instances = instances_.size();
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t instance_pool_size = new_pool_size / num_instances + (i < new_pool_size % num_instances ? 1 : 0);
+    if (instance_pool_size == 0 || instance_pool_size > instances_[i]->max_pool_size_) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_[i]->Resize(new_pool_size / num_instances + (i < new_pool_size % num_instances ? 1 : 0));
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::SaveResidentPages(const std::string &file_name) {
+  std::vector<std::vector<page_id_t>> resident_pages;
+  size_t max_num_pages = 0;
+  for (auto *instance : instances_) {
+    resident_pages.push_back(instance->GetResidentPages());
+    max_num_pages = std::max(max_num_pages, resident_pages.back().size());
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < max_num_pages; ++rank) {
+    for (auto &instance_pages : resident_pages) {
+      if (rank < instance_pages.size()) {
+        page_ids.push_back(instance_pages[rank]);
+      }
+    }
+  }
+  BufferPoolManagerInstance::WritePageList(file_name, page_ids);
+}
+
+void ParallelBufferPoolManager::WarmUp(const std::string &file_name) {
+  std::vector<std::vector<page_id_t>> page_ids(instances_.size());
+  for (auto page_id : BufferPoolManagerInstance::ReadPageList(file_name)) {
+    if (page_id != INVALID_PAGE_ID) {
+      page_ids[static_cast<uint32_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->StartWarmUp(std::move(page_ids[i]));
+  }
+}
+
+void ParallelBufferPoolManager::WaitForWarmUp() {
+  for (auto *instance : instances_) {
+    instance->WaitForWarmUp();
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  std::vector<std::vector<page_id_t>> batches(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      batches[static_cast<uint32_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!batches[i].empty()) {
+      instances_[i]->PrefetchPages(batches[i], access_type);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(double dirty_ratio, size_t max_pages) {
+  for (auto *instance : instances_) {
+    instance->StartBackgroundWriter(dirty_ratio, max_pages);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+void ParallelBufferPoolManager::EnableCompressedCache(size_t capacity) {
+  for (auto *instance : instances_) {
+    instance->EnableCompressedCache(capacity / instances_.size());
+  }
+}
+
+CompressedCacheStats ParallelBufferPoolManager::GetCompressedCacheStats() {
+  CompressedCacheStats stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetCompressedCacheStats();
+  }
+  return stats;
+}
+
+uint64_t ParallelBufferPoolManager::GetNumForegroundWrites() {
+  uint64_t num_writes = 0;
+  for (auto *instance : instances_) {
+    num_writes += instance->GetNumForegroundWrites();
+  }
+  return num_writes;
+}
+
+uint64_t ParallelBufferPoolManager::GetNumBackgroundWrites() {
+  uint64_t num_writes = 0;
+  for (auto *instance : instances_) {
+    num_writes += instance->GetNumBackgroundWrites();
+  }
+  return num_writes;
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  return instances_[static_cast<uint32_t>(page_id) % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType access_type) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  return NewPageNearImpl(page_id, INVALID_PAGE_ID, INVALID_OWNER_ID);
+}
+
+Page *ParallelBufferPoolManager::NewPageNearImpl(page_id_t *page_id, page_id_t hint, owner_id_t owner) {
+  // The owning instance is a function of the page id, so the id has to be allocated before a frame can be picked. An
+  // id that a stale copy of a deleted page still uses is kept allocated until another id is found, so that it is not
+  // taken again.
+  std::vector<page_id_t> stale_page_ids;
+  page_id_t new_page_id;
+  Page *page;
+  bool in_use;
+  do {
+    new_page_id = disk_manager_->AllocatePage(hint, owner);
+    page = GetBufferPoolManager(new_page_id)->NewPageWithId(new_page_id, &in_use);
+    if (in_use) {
+      stale_page_ids.push_back(new_page_id);
+    }
+  } while (page == nullptr && in_use);
+
+  for (auto stale_page_id : stale_page_ids) {
+    disk_manager_->DeallocatePage(stale_page_id);
+  }
+  // Only an id for which no frame could be found is given back.
+  if (page == nullptr) {
+    disk_manager_->DeallocatePage(new_page_id);
+    *page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  return page;
+}
+
+void ParallelBufferPoolManager::ReleaseOwnerImpl(owner_id_t owner) { disk_manager_->ReleaseOwner(owner); }
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // Pages with neighbouring ids belong to different instances, so collect the dirty pages of all instances before
+  // writing, or nothing could be coalesced. Each latch is only held while its pages are collected and pinned.
+  std::vector<Page *> dirty_pages;
+  std::vector<size_t> ends;
+  for (auto *instance : instances_) {
+    std::unique_lock<std::mutex> lock(instance->latch_);
+    instance->io_cv_.wait(lock, [&] { return instance->bg_writing_pages_.empty(); });
+    instance->CollectDirtyPages(&dirty_pages);
+    ends.push_back(dirty_pages.size());
+  }
+  BufferPoolManagerInstance::WriteBackPages(disk_manager_, dirty_pages);
+
+  size_t begin = 0;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->UnpinCollectedPages(dirty_pages.begin() + begin, dirty_pages.begin() + ends[i]);
+    begin = ends[i];
+  }
+}
+
+}  // namespace bustub
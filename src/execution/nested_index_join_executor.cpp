@@ -32,11 +32,32 @@ void NestIndexJoinExecutor::Init() {
   IndexInfo *index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexName(), table_matadata->name_);
   auto index = static_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
 
+  // Collect the RIDs a batch at a time and prefetch their pages before reading the tuples, so that the reads overlap.
+  // The table may be bound to a buffer pool of its own.
+  BufferPoolManager *bpm = table->GetBufferPoolManager();
+  std::vector<RID> rids;
+  std::vector<page_id_t> page_ids;
   Tuple tuple;
+  auto read_batch = [&] {
+    bpm->PrefetchPages(page_ids);
+    for (const auto &rid : rids) {
+      table->GetTuple(rid, &tuple, txn_);
+      inner_tuples_.emplace_back(tuple);
+    }
+    rids.clear();
+    page_ids.clear();
+  };
   for (auto it = index->GetBeginIterator(); !it.IsEnd(); ++it) {
-    table->GetTuple((*it).second, &tuple, txn_);
-    inner_tuples_.emplace_back(tuple);
+    RID rid = (*it).second;
+    rids.push_back(rid);
+    if (page_ids.empty() || page_ids.back() != rid.GetPageId()) {
+      page_ids.push_back(rid.GetPageId());
+    }
+    if (page_ids.size() == PREFETCH_BATCH_SIZE) {
+      read_batch();
+    }
   }
+  read_batch();
 
   inner_idx_ = 0;
   inner_size_ = inner_tuples_.size();
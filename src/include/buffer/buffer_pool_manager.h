@@ -12,42 +12,51 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <atomic>
+#include <string>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
-#include "recovery/log_manager.h"
-#include "storage/disk/disk_manager.h"
+#include "common/config.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * How a caller is going to use the pages it fetches.
+ * Normal pages go through the replacer. Pages fetched for a sequential scan or a bulk write are only touched once,
+ * so on a miss they are read into a small ring of frames that is recycled in order, and they do not push the working
+ * set out of the pool. A page from the ring that is then fetched with Normal access is handed over to the replacer.
+ */
+enum class AccessType { Normal, SequentialScan, BulkWrite };
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * This is the interface shared by a single BufferPoolManagerInstance and the sharded ParallelBufferPoolManager.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, AccessType::Normal);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /** Fetches a page with the given access type. */
+  Page *FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPageImpl(page_id, access_type);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
@@ -91,11 +100,73 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Creates a new page that is placed close to another page on disk where possible, e.g. the sibling of a node that
+   * is split, so that pages that are used together stay together in the file.
+   * @param[out] page_id id of created page
+   * @param hint id of the page the new page is used with, or INVALID_PAGE_ID
+   * @param owner id of the table or index the page belongs to from NewOwnerId, or INVALID_OWNER_ID. Its pages are
+   * allocated in extents of contiguous pages, see DiskManager::AllocatePage.
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageNear(page_id_t *page_id, page_id_t hint, owner_id_t owner = INVALID_OWNER_ID) {
+    return NewPageNearImpl(page_id, hint, owner);
+  }
+
+  /**
+   * Gives up the extent of an owner that creates no more pages, see DiskManager::ReleaseOwner.
+   * @param owner id of the table or index from NewOwnerId
+   */
+  void ReleaseOwner(owner_id_t owner) { ReleaseOwnerImpl(owner); }
+
+  /** @return a new id for a table or index that creates its pages with NewPageNear, unique within the process */
+  static owner_id_t NewOwnerId() {
+    static std::atomic<owner_id_t> next_owner_id{0};
+    return next_owner_id++;
+  }
+
+  /**
+   * Starts reading a page into the buffer pool without pinning it, so that a later FetchPage is a hit.
+   * @param page_id id of the page to prefetch
+   * @param access_type how the page is going to be used
+   */
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Normal) {
+    PrefetchPages({page_id}, access_type);
+  }
+
+  /**
+   * Starts reading pages into the buffer pool without pinning them and returns without waiting for the reads.
+   * Pages that are already resident are skipped. Prefetching is a hint: it gives up instead of waiting for a frame.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type how the pages are going to be used
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Normal) = 0;
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * Changes the number of frames while the buffer pool is in use. Growing adds free frames. Shrinking stops handing
+   * out the frames that go away, writes back and evicts their pages, and waits for pinned ones to be unpinned first.
+   * @param new_pool_size the new number of frames
+   * @return false if the buffer pool cannot have that many frames, true once it has been resized
+   */
+  virtual bool Resize(size_t new_pool_size) = 0;
+
+  /**
+   * Writes the ids of the resident pages to a file, most recently used first, so that a later WarmUp can load them
+   * again. Can be called at shutdown or periodically.
+   * @param file_name the file to write
+   */
+  virtual void SaveResidentPages(const std::string &file_name) = 0;
+
+  /**
+   * Starts loading the pages listed by SaveResidentPages in the background and returns without waiting. Pages are
+   * only loaded into free frames, most recently used first, and FetchPage keeps working meanwhile. A missing or
+   * malformed file is ignored.
+   * @param file_name the file written by SaveResidentPages
+   */
+  virtual void WarmUp(const std::string &file_name) = 0;
 
  protected:
   /**
@@ -114,9 +185,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id, AccessType access_type) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,49 +196,51 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id) = 0;
+
+  /**
+   * Creates a new page in the buffer pool, close to another page on disk. Ignores the hint and the owner unless
+   * overridden.
+   * @param[out] page_id id of created page
+   * @param hint id of the page the new page is used with, or INVALID_PAGE_ID
+   * @param owner id of the table or index the page belongs to, or INVALID_OWNER_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageNearImpl(page_id_t *page_id, __attribute__((unused)) page_id_t hint,
+                                __attribute__((unused)) owner_id_t owner) {
+    return NewPageImpl(page_id);
+  }
+
+  /**
+   * Gives up the extent of an owner. Does nothing unless overridden.
+   * @param owner id of the table or index
+   */
+  virtual void ReleaseOwnerImpl(__attribute__((unused)) owner_id_t owner) {}
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
 };
 }  // namespace bustub
@@ -0,0 +1,567 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool.
+ *
+ * Hits on resident pages take no latch: the page table is lock-free for readers, and a frame is pinned by
+ * incrementing its pin count with a compare-and-swap. Everything that reuses a frame first swaps its pin count from 0
+ * to FRAME_LOCKED under the latch, which fails if the frame was pinned meanwhile.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+  // The parallel buffer pool allocates page ids itself and routes each new page to the instance that owns it.
+  friend class ParallelBufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param max_pool_size the largest size Resize may grow the pool to, 0 for pool_size
+   * @param correlated_window correlated reference window of an LRU-K replacer, in accesses
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0,
+                            size_t correlated_window = LRUK_CORRELATED_WINDOW);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param max_pool_size the largest size Resize may grow the pool to, 0 for pool_size
+   * @param correlated_window correlated reference window of an LRU-K replacer, in accesses
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0,
+                            size_t correlated_window = LRUK_CORRELATED_WINDOW);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() { return pages_; }
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /**
+   * Changes the number of frames, up to the max_pool_size given at construction. Frame memory, the page table and the
+   * replacer are sized for max_pool_size up front, so resizing never moves a frame and the lock-free hit path is not
+   * affected. Frames that go away keep their metadata and give their page data memory back to the kernel.
+   * Shrinking blocks until every page in the frames that go away is unpinned.
+   * @param new_pool_size the new number of frames
+   * @return false if new_pool_size is 0 or larger than max_pool_size, true once the pool has been resized
+   */
+  bool Resize(size_t new_pool_size) override;
+
+  /**
+   * Reserves a frame for every page that is not resident and hands the reads to the prefetch thread. At most a
+   * quarter of the pool is taken up by prefetches that have not completed yet.
+   * @param page_ids ids of the pages to prefetch, all owned by this instance
+   * @param access_type how the pages are going to be used, which decides where their frames come from
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Normal) override;
+
+  /**
+   * Starts a thread that runs WriteBackDirtyPages every bg_writer_interval, so that foreground threads mostly find
+   * clean victims and do not have to wait for a write on a miss.
+   * @param dirty_ratio share of the pool that may stay dirty
+   * @param max_pages maximum number of pages written per round, which bounds the write rate
+   */
+  void StartBackgroundWriter(double dirty_ratio = BG_WRITER_DIRTY_RATIO, size_t max_pages = BG_WRITER_MAX_PAGES);
+
+  /** Stops and joins the background writer thread, if it is running. */
+  void StopBackgroundWriter();
+
+  /**
+   * Writes back dirty, unpinned pages and marks them clean: first those among the next victims of the replacer, then,
+   * while more than dirty_ratio of the pool is dirty, any others. Pages whose LSN is not yet persistent in the log are
+   * skipped.
+   * @param dirty_ratio share of the pool that may stay dirty
+   * @param max_pages maximum number of pages to write
+   * @return the number of pages written
+   */
+  size_t WriteBackDirtyPages(double dirty_ratio, size_t max_pages);
+
+  /**
+   * Writes the ids of the resident pages to a file, most recently used first.
+   * @param file_name the file to write
+   */
+  void SaveResidentPages(const std::string &file_name) override;
+
+  /**
+   * Starts a thread that reads the pages listed in the file into free frames. The pages that fit are read in order of
+   * their ids, and runs of consecutive pages are read with a single DiskManager::ReadPages.
+   * @param file_name the file written by SaveResidentPages
+   */
+  void WarmUp(const std::string &file_name) override;
+
+  /** Waits until a warmup started by WarmUp has finished. */
+  void WaitForWarmUp();
+
+  /** @return the number of pages loaded by warmups */
+  uint64_t GetNumWarmedPages() const { return num_warmed_pages_; }
+
+  /**
+   * Keeps evicted pages compressed in memory from now on, so that fetching them again does not read from disk. Pages
+   * evicted from the rings are not kept, as scans and bulk writes are not expected to come back to them. Calling it
+   * again changes the capacity.
+   * @param capacity the largest number of bytes the compressed pages may take up
+   */
+  void EnableCompressedCache(size_t capacity);
+
+  /** @return the counters of the compressed cache, all 0 if it is not enabled */
+  CompressedCacheStats GetCompressedCacheStats();
+
+  /** @return the number of fetches that did not find the page resident */
+  uint64_t GetNumMisses() const { return num_misses_; }
+
+  /** @return the number of dirty victims written back to make room for a page, including prefetched pages */
+  uint64_t GetNumForegroundWrites() const { return num_foreground_writes_; }
+
+  /** @return the number of pages written back by WriteBackDirtyPages */
+  uint64_t GetNumBackgroundWrites() const { return num_background_writes_; }
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool, on a free page of the disk close to the hint or in the extent of the owner.
+   * @param[out] page_id id of created page
+   * @param hint id of the page the new page is used with, or INVALID_PAGE_ID
+   * @param owner id of the table or index the page belongs to, or INVALID_OWNER_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageNearImpl(page_id_t *page_id, page_id_t hint, owner_id_t owner) override;
+
+  /**
+   * Gives up the extent of an owner on the disk manager.
+   * @param owner id of the table or index
+   */
+  void ReleaseOwnerImpl(owner_id_t owner) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+  /** Number of pages in the buffer pool. Frames from pool_size_ on are not handed out for new pages. */
+  std::atomic<size_t> pool_size_;
+  /** The largest size the pool can be resized to. Everything indexed by frame id is allocated for this many frames. */
+  const size_t max_pool_size_;
+  /** Number of frames whose metadata in pages_ has been constructed, protected by latch_. */
+  size_t num_frames_{0};
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** Array of buffer pool pages. */
+  Page *pages_;
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_;
+  /** Page data of every frame, separate from the metadata in pages_. */
+  FrameArena frame_arena_;
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, changes need the latch. */
+  PageTable page_table_;
+  /**
+   * Runs the reads of misses and prefetches and the writes of victims and of the background writer, so that the I/Os
+   * of concurrent misses and of a batch of prefetches or background writes overlap. nullptr without a disk manager.
+   */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** Replacer to find unpinned pages for replacement. */
+  Replacer *replacer_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** Serializes calls to Resize. Taken before latch_. */
+  std::mutex resize_latch_;
+  /**
+   * This latch protects changes to the page table, the free list, the rings and the I/O state, and is needed to
+   * reuse a frame. Pinning and unpinning a resident page do not need it.
+   */
+  std::mutex latch_;
+  /** True for frames whose page is being written back or read in with the latch released. Set under the latch. */
+  std::unique_ptr<std::atomic<bool>[]> io_in_progress_;
+  /** Victims that are being compressed or written back and must not be read in until that is done. */
+  std::unordered_set<page_id_t> evicting_pages_;
+  /** Pages the background writer is writing a copy of. The page may be evicted but not read back in meanwhile. */
+  std::unordered_set<page_id_t> bg_writing_pages_;
+  /** Signalled whenever a frame finishes its I/O, and whenever a frame that goes away is unpinned or emptied. */
+  std::condition_variable io_cv_;
+
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *bg_writer_thread_{nullptr};
+  /** True while the background writer should keep running. */
+  std::atomic<bool> enable_bg_writer_{false};
+  /** Next frame the background writer looks at when too much of the pool is dirty. */
+  size_t bg_writer_cursor_{0};
+  /** Fetches that did not find the page resident. */
+  std::atomic<uint64_t> num_misses_{0};
+  /** Dirty victims written back by foreground threads. */
+  std::atomic<uint64_t> num_foreground_writes_{0};
+  /** Pages written back by the background writer. */
+  std::atomic<uint64_t> num_background_writes_{0};
+
+  /**
+   * Compressed copies of evicted pages, nullptr if not enabled. A page is never both resident and in the cache: it is
+   * put in when it is evicted and taken out when it is read back in. Set once under the latch.
+   */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+
+  /** The page that leaves a frame to make room for another, and what is done with it once the latch is released. */
+  struct EvictedPage {
+    /** Id of the victim, INVALID_PAGE_ID if nothing has to be done with it. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** The victim is dirty and is written back. */
+    bool write_back_{false};
+    /** The victim is put in the compressed cache. */
+    bool compress_{false};
+  };
+
+  /** A page read started by PrefetchPages. Its frame is in the page table, unpinned and marked as having I/O. */
+  struct PrefetchRequest {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    /** Victim to compress and write back first. */
+    EvictedPage evicted_;
+  };
+  /** Reads waiting for the prefetch thread, protected by latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Prefetches that have not completed yet, queued or running. */
+  size_t num_prefetches_in_flight_{0};
+  /** Signalled when a prefetch is queued or the prefetch thread should stop. */
+  std::condition_variable prefetch_cv_;
+  /** The prefetch thread, started by the first prefetch. nullptr if it is not running. */
+  std::thread *prefetch_thread_{nullptr};
+  /** True while the prefetch thread should keep running. */
+  bool enable_prefetcher_{false};
+
+  /** The warmup thread, nullptr if no warmup was started. */
+  std::thread *warmup_thread_{nullptr};
+  /** Cleared to stop a running warmup early. */
+  std::atomic<bool> enable_warmup_{false};
+  /** Pages loaded by warmups. */
+  std::atomic<uint64_t> num_warmed_pages_{0};
+
+  /**
+   * A small set of frames that scans and bulk writes recycle in order instead of evicting pages through the replacer.
+   * Ring frames are never handed to the replacer while they are in the ring.
+   */
+  struct FrameRing {
+    /** Maximum number of frames in the ring. */
+    size_t capacity_{0};
+    /** Frames in the ring, recycled in order. */
+    std::vector<frame_id_t> frames_;
+    /** Position in frames_ of the next frame to recycle. */
+    size_t next_{0};
+  };
+  /** Ring used by AccessType::SequentialScan. */
+  FrameRing scan_ring_;
+  /** Ring used by AccessType::BulkWrite. */
+  FrameRing bulk_write_ring_;
+  /** The ring each frame belongs to, nullptr for frames managed by the replacer. Set under the latch. */
+  std::unique_ptr<std::atomic<FrameRing *>[]> frame_rings_;
+
+ private:
+  /** First word of a file written by WritePageList. */
+  static constexpr uint32_t PAGE_LIST_MAGIC = 0x4c504257;
+
+  /** Pin count of a frame that is free or reserved by a thread holding the latch. Lock-free pins fail on it. */
+  static constexpr int FRAME_LOCKED = -1;
+
+  /**
+   * Pins a resident page without the latch.
+   * @param frame_id frame the page table returned for the page
+   * @param page_id id of the page
+   * @param access_type how the page is going to be used
+   * @return false if the frame holds another page by now, its I/O is not done, or the page has to leave a ring,
+   * in which case the caller takes the latch
+   */
+  bool TryPinResident(frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /**
+   * Releases a pin without the latch. Whoever releases the last pin hands the frame to the replacer.
+   * @param frame_id frame of the page
+   * @param is_dirty true if the page was modified
+   * @return false if the frame was not pinned, true otherwise
+   */
+  bool UnpinFrame(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Ends the I/O of a frame that was read in without a pin, for a prefetch or a warmup, and hands the frame to the
+   * replacer unless it is pinned or in a ring. The latch must be held.
+   * @param frame_id frame whose read is done
+   */
+  void FinishUnpinnedIo(frame_id_t frame_id);
+
+  /**
+   * Reserves an unpinned frame that has no I/O in progress by swapping its pin count to FRAME_LOCKED. The latch
+   * must be held.
+   * @return false if the frame is pinned or busy, true otherwise
+   */
+  bool LockFrame(frame_id_t frame_id);
+
+  /**
+   * Creates a new page with an already allocated id. Used by ParallelBufferPoolManager.
+   * @param page_id id of the new page, must be owned by this instance
+   * @param[out] in_use set to true if a stale copy of a deleted page with the same id is still in use, see CreatePage
+   * @return nullptr if the id is in use or no frame could be found, otherwise pointer to the new page
+   */
+  Page *NewPageWithId(page_id_t page_id, bool *in_use);
+
+  /**
+   * Creates a new page with an already allocated id. A copy of a deleted page may still be resident under the id,
+   * read in by a caller that held on to the id, e.g. an index lookup that read the old root id. The copy is dropped if
+   * nobody uses it, otherwise the id cannot be used until it is unpinned. The latch must be held.
+   * @param lock the held latch, released while waiting for a frame or during I/O
+   * @param page_id id of the new page
+   * @param[out] in_use set to true if the id is in use by a stale copy, false otherwise
+   * @return nullptr if the id is in use or no frame could be found, otherwise pointer to the new page
+   */
+  Page *CreatePage(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool *in_use);
+
+  /**
+   * Empties a locked frame and hands it back to the free list, or to Resize if the frame goes away. The latch must be
+   * held.
+   * @param frame_id frame locked with LockFrame
+   */
+  void DropPage(frame_id_t frame_id);
+
+  /**
+   * Finds a frame to hold a new page, from the free list first, then from the replacer and, as a last resort, from
+   * an unpinned ring frame. The victim is removed from the page table, but stays in the frame until the caller has
+   * compressed and written it back. The latch must be held.
+   * @param[out] frame_id id of the frame that was found
+   * @param[out] evicted the victim and what has to be done with it
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindFreeFrame(frame_id_t *frame_id, EvictedPage *evicted);
+
+  /**
+   * Marks a victim as being evicted, so that it is not read in until CompressEvictedPage and its write back are done
+   * and the caller has removed it from evicting_pages_. The latch must be held.
+   * @param lock the held latch, released while an older copy of the victim is written by the background writer
+   * @param evicted the victim returned by FindFreeFrame or FindRingFrame
+   */
+  void BeginEviction(std::unique_lock<std::mutex> *lock, const EvictedPage &evicted);
+
+  /**
+   * Puts a victim in the compressed cache if it goes there. Called with the latch released, after BeginEviction.
+   * @param evicted the victim returned by FindFreeFrame or FindRingFrame
+   * @param data the content of the victim, still in its frame
+   */
+  void CompressEvictedPage(const EvictedPage &evicted, const char *data);
+
+  /**
+   * Installs a page in a frame returned by FindFreeFrame and pins it. Compressing and writing back the victim and
+   * reading the page in are done with the latch released while the frame is marked as having I/O in progress.
+   * @param lock the held latch, released during I/O and held again on return
+   * @param frame_id frame returned by FindFreeFrame
+   * @param page_id id of the page to install
+   * @param evicted the victim to compress and write back first
+   * @param read_from_disk true to read the page content from the compressed cache or the disk, false to zero it (new
+   * page)
+   * @return pointer to the installed page
+   */
+  Page *InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id, page_id_t page_id,
+                    const EvictedPage &evicted, bool read_from_disk);
+
+  /**
+   * Evicts the page in a frame that goes away when the pool shrinks, compressing it and writing it back if it is
+   * dirty with the latch released. The frame stays locked and out of the free list.
+   * @param lock the held latch, released during I/O and held again on return
+   * @param frame_id frame locked with LockFrame
+   */
+  void RetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Sizes the rings for the current pool size. Frames beyond the capacity of a ring become ordinary frames. The latch
+   * must be held.
+   */
+  void SetRingCapacities();
+
+  /** @return the ring used by the access type, nullptr for AccessType::Normal */
+  FrameRing *GetRing(AccessType access_type);
+
+  /**
+   * Finds a frame to hold a new page for a ring. A ring that is not full yet grows by one frame from FindFreeFrame.
+   * A full ring recycles its next frame. If that frame is pinned by someone else it leaves the ring and the ring grows
+   * from FindFreeFrame instead. The latch must be held.
+   * @param ring the ring to find a frame for
+   * @param[out] frame_id id of the frame that was found
+   * @param[out] evicted the victim and what has to be done with it
+   * @return false if no frame could be found, true otherwise
+   */
+  bool FindRingFrame(FrameRing *ring, frame_id_t *frame_id, EvictedPage *evicted);
+
+  /**
+   * Called when every frame is pinned or being prefetched. A prefetched frame can be evicted once its read is done,
+   * so wait for the next I/O to finish if any prefetch is still in flight.
+   * @param lock the held latch
+   * @return false if no prefetch is in flight and there is no point in waiting, true after waiting
+   */
+  bool WaitForPrefetch(std::unique_lock<std::mutex> *lock);
+
+  /** Body of the prefetch thread. Serves the prefetch queue until the prefetcher is disabled and the queue is empty. */
+  void RunPrefetcher();
+
+  /**
+   * @return the ids of the resident pages, most recently used first: pinned pages, then the pages the replacer would
+   * evict last. Pages in a ring and pages being read in are left out.
+   */
+  std::vector<page_id_t> GetResidentPages();
+
+  /**
+   * Starts a thread that runs RunWarmUp. Stops a warmup that is still running first.
+   * @param page_ids ids of pages owned by this instance, most recently used first
+   */
+  void StartWarmUp(std::vector<page_id_t> page_ids);
+
+  /** Body of the warmup thread. */
+  void RunWarmUp(std::vector<page_id_t> page_ids);
+
+  /** Stops and joins the warmup thread, if there is one. */
+  void StopWarmUp();
+
+  /**
+   * Writes a list of page ids in the format read by ReadPageList.
+   * @param file_name the file to write
+   * @param page_ids the page ids
+   */
+  static void WritePageList(const std::string &file_name, const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Reads a list of page ids written by WritePageList.
+   * @param file_name the file to read
+   * @return the page ids, empty if the file is missing or malformed
+   */
+  static std::vector<page_id_t> ReadPageList(const std::string &file_name);
+
+  /**
+   * Adds the dirty pages of this instance to a list, pins them and marks them clean. The latch must be held, and is
+   * released before the pages are written back. Once they are, UnpinCollectedPages releases them.
+   * @param[out] dirty_pages the list to add the pages to
+   */
+  void CollectDirtyPages(std::vector<Page *> *dirty_pages);
+
+  /**
+   * Unpins pages of this instance that CollectDirtyPages pinned. The latch must not be held.
+   * @param begin first page to unpin
+   * @param end end of the pages to unpin
+   */
+  void UnpinCollectedPages(std::vector<Page *>::const_iterator begin, std::vector<Page *>::const_iterator end);
+
+  /**
+   * Writes back pages with a single DiskManager::WritePages, which sorts and coalesces them and syncs the file once.
+   * @param disk_manager the disk manager to write to
+   * @param pages the pages to write, collected by CollectDirtyPages
+   */
+  static void WriteBackPages(DiskManager *disk_manager, const std::vector<Page *> &pages);
+
+  /** Body of the background writer thread. */
+  void RunBackgroundWriter(double dirty_ratio, size_t max_pages);
+
+  /**
+   * WriteBackDirtyPages with a staging buffer that the caller allocated.
+   * @param dirty_ratio share of the pool that may stay dirty
+   * @param max_pages maximum number of pages to write, at most max_pool_size_
+   * @param copies max_pages * PAGE_SIZE aligned bytes to copy the pages to before they are written
+   * @return the number of pages written
+   */
+  size_t WriteBackDirtyPages(double dirty_ratio, size_t max_pages, char *copies);
+
+  /**
+   * Copies a dirty, unpinned page to be written back and marks it clean. The page is added to bg_writing_pages_, and
+   * the caller removes it once the copy is on disk. The latch must be held.
+   * @param frame_id frame of the page
+   * @param[out] copy PAGE_SIZE bytes to copy the page to
+   * @param[out] page_id id of the page
+   * @return false if the page is clean, pinned, busy or not covered by the persistent log yet, true otherwise
+   */
+  bool CopyForWriteBack(frame_id_t frame_id, char *copy, page_id_t *page_id);
+
+  /** Takes a frame out of its ring. The caller is responsible for handing it to the replacer or the free list. */
+  void RemoveFromRing(frame_id_t frame_id);
+};
+}  // namespace bustub
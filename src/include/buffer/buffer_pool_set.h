@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set.h
+//
+// Identification: src/include/buffer/buffer_pool_set.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Counters of one buffer pool. */
+struct BufferPoolStats {
+  /** Number of frames. */
+  size_t pool_size_{0};
+  /** Fetches that did not find the page resident. */
+  uint64_t num_misses_{0};
+  /** Dirty victims written back to make room for a page. */
+  uint64_t num_foreground_writes_{0};
+  /** Pages written back by the background writer. */
+  uint64_t num_background_writes_{0};
+  /** Counters of the compressed cache, all 0 if it is not enabled. */
+  CompressedCacheStats compressed_cache_;
+};
+
+/**
+ * BufferPoolSet is a set of named buffer pools on top of one disk manager, so that classes of objects do not compete
+ * for the same frames. For example, a large scan of the heap pool cannot evict the upper levels of the B+trees in the
+ * index pool. Every pool has its own size, replacer and latch.
+ *
+ * Page ids are allocated by the shared disk manager, so the pools never hand out the same page id twice. Each page
+ * must only be accessed through one pool, which holds as long as each object is bound to one pool.
+ */
+class BufferPoolSet {
+ public:
+  /** Pool for index pages. */
+  static constexpr const char *INDEX_POOL = "index";
+  /** Pool for table heap pages. */
+  static constexpr const char *HEAP_POOL = "heap";
+  /** Pool for temporary pages, such as hash tables built by executors. */
+  static constexpr const char *TEMP_POOL = "temp";
+
+  /**
+   * Creates a new BufferPoolSet without pools.
+   * @param disk_manager the disk manager shared by all pools
+   * @param log_manager the log manager shared by all pools (for testing only: nullptr = disable logging)
+   */
+  explicit BufferPoolSet(DiskManager *disk_manager, LogManager *log_manager = nullptr)
+      : disk_manager_(disk_manager), log_manager_(log_manager) {}
+
+  /**
+   * Adds a pool.
+   * @param name the name of the pool, must be unique
+   * @param pool_size the number of frames of the pool
+   * @param replacer_type the replacement policy of the pool
+   * @param max_pool_size the largest size ResizePool may grow the pool to, 0 for pool_size
+   * @param correlated_window correlated reference window of an LRU-K replacer, in accesses
+   * @return the new pool
+   */
+  BufferPoolManagerInstance *AddPool(const std::string &name, size_t pool_size,
+                                     ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0,
+                                     size_t correlated_window = LRUK_CORRELATED_WINDOW);
+
+  /**
+   * @param name the name of the pool
+   * @return the pool
+   * @throws std::out_of_range if there is no pool with that name
+   */
+  BufferPoolManagerInstance *GetPool(const std::string &name);
+
+  /** @return true if there is a pool with the name */
+  bool HasPool(const std::string &name);
+
+  /** @return the names of the pools in alphabetical order */
+  std::vector<std::string> GetPoolNames();
+
+  /** @return the number of frames of all pools together */
+  size_t GetTotalPoolSize();
+
+  /**
+   * Changes the size of a pool, which moves memory between pools when another one is shrunk first.
+   * @param name the name of the pool
+   * @param new_pool_size the new number of frames
+   * @return false if the pool cannot have that many frames, true once it has been resized
+   * @throws std::out_of_range if there is no pool with that name
+   */
+  bool ResizePool(const std::string &name, size_t new_pool_size);
+
+  /**
+   * @param name the name of the pool
+   * @return the counters of the pool
+   * @throws std::out_of_range if there is no pool with that name
+   */
+  BufferPoolStats GetStats(const std::string &name);
+
+  /** Flushes the pages of every pool to disk. */
+  void FlushAllPages();
+
+ private:
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  /** Protects pools_. The pools themselves are thread-safe. */
+  std::mutex latch_;
+  /** The pools by name. */
+  std::map<std::string, std::unique_ptr<BufferPoolManagerInstance>> pools_;
+};
+
+}  // namespace bustub
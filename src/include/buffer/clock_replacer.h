@@ -12,8 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +23,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has an atomic state word holding its reference bit and whether it is in the replacer, so Pin, Unpin and
+ * RecordAccess are single atomic read-modify-writes and never block. Victim advances the shared clock hand atomically
+ * and claims a frame with a compare-and-swap, so concurrent callers never hand out the same frame.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +47,27 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  std::vector<frame_id_t> PeekVictims(size_t max_frames) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame is in the replacer and may be evicted. */
+  static constexpr uint8_t EVICTABLE = 0x1;
+  /** The frame was used since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  size_t num_pages_;
+  /** Per-frame EVICTABLE | REFERENCED bits. */
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /** Position of the clock hand, taken modulo num_pages_. */
+  std::atomic<size_t> hand_{0};
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
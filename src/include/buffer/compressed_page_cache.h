@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Counters of a CompressedPageCache. */
+struct CompressedCacheStats {
+  /** Lookups of pages that were not in the buffer pool. */
+  uint64_t num_lookups_{0};
+  /** Lookups that found the page. */
+  uint64_t num_hits_{0};
+  /** Pages put in the cache. */
+  uint64_t num_puts_{0};
+  /** Size of the pages put in the cache before compression. */
+  uint64_t raw_bytes_{0};
+  /** Size of the pages put in the cache after compression. */
+  uint64_t stored_bytes_{0};
+
+  /** @return the share of lookups that found the page, 0 if there were none */
+  double GetHitRate() const { return num_lookups_ == 0 ? 0 : static_cast<double>(num_hits_) / num_lookups_; }
+
+  /** @return how many times smaller the pages got, 0 if none were put */
+  double GetCompressionRatio() const {
+    return stored_bytes_ == 0 ? 0 : static_cast<double>(raw_bytes_) / stored_bytes_;
+  }
+
+  CompressedCacheStats &operator+=(const CompressedCacheStats &other) {
+    num_lookups_ += other.num_lookups_;
+    num_hits_ += other.num_hits_;
+    num_puts_ += other.num_puts_;
+    raw_bytes_ += other.raw_bytes_;
+    stored_bytes_ += other.stored_bytes_;
+    return *this;
+  }
+};
+
+/**
+ * CompressedPageCache keeps pages evicted from the buffer pool in memory, compressed with PageCodec, so that reading
+ * them back does not go to disk. It is a victim cache: a page is only in it while it is not in the buffer pool, and
+ * Take removes it. The compressed pages take up at most capacity bytes, and the least recently put ones are dropped
+ * to make room. Pages that do not compress are kept as they are.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Creates a new CompressedPageCache.
+   * @param capacity the largest number of bytes the compressed pages may take up
+   */
+  explicit CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Compresses a page and adds it, replacing an older copy.
+   * @param page_id id of the page
+   * @param data the page content, PAGE_SIZE bytes
+   */
+  void Put(page_id_t page_id, const char *data);
+
+  /**
+   * Removes a page and decompresses it.
+   * @param page_id id of the page
+   * @param[out] data the page content, PAGE_SIZE bytes
+   * @return false if the page is not in the cache
+   */
+  bool Take(page_id_t page_id, char *data);
+
+  /**
+   * Removes a page if it is in the cache.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /**
+   * Changes the capacity, dropping the least recently put pages if they do not fit anymore.
+   * @param capacity the largest number of bytes the compressed pages may take up
+   */
+  void SetCapacity(size_t capacity);
+
+  /** @return the largest number of bytes the compressed pages may take up */
+  size_t GetCapacity();
+
+  /** @return the number of bytes the compressed pages take up */
+  size_t GetSize();
+
+  /** @return the number of pages in the cache */
+  size_t GetNumPages();
+
+  /** @return the counters of the cache */
+  CompressedCacheStats GetStats();
+
+ private:
+  /** A page in the cache. */
+  struct Entry {
+    /** The compressed page, or the page itself if it did not compress. */
+    std::unique_ptr<char[]> data_;
+    /** Size of data_. */
+    size_t size_;
+    /** Position of the page in lru_. */
+    std::list<page_id_t>::iterator lru_iter_;
+  };
+
+  /** Removes an entry. The latch must be held. */
+  void EraseEntry(std::unordered_map<page_id_t, Entry>::iterator iter);
+
+  /** Drops the least recently put pages until size_ fits in capacity_. The latch must be held. */
+  void EvictToCapacity();
+
+  std::mutex latch_;
+  size_t capacity_;
+  /** Bytes taken up by the entries. */
+  size_t size_{0};
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Pages in the cache, most recently put first. */
+  std::list<page_id_t> lru_;
+  CompressedCacheStats stats_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the page data of every frame in a buffer pool as one contiguous block of memory.
+ *
+ * Every frame starts on a PAGE_SIZE boundary, so frames can be handed to the disk directly, e.g. with O_DIRECT.
+ * Arenas of at least one huge page are aligned to the huge page size and advised for transparent huge pages where the
+ * platform supports it, which keeps the TLB footprint of a large pool small. The frame metadata is kept elsewhere, so
+ * pin counts and latches never share a cache line with page data.
+ */
+class FrameArena {
+ public:
+  /** Size of the huge pages the arena is aligned to. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Maps zeroed memory for num_frames frames. Memory is only committed when a frame is first touched, so reserving
+   * room for more frames than are used costs address space only.
+   * @param num_frames the number of frames
+   */
+  explicit FrameArena(size_t num_frames);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /** @return the data of the given frame */
+  char *GetFrame(frame_id_t frame_id) const { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Gives the memory of frames that are no longer in use back to the kernel. They read as zeros when used again.
+   * @param first_frame_id the first frame to release
+   * @param num_frames the number of frames to release
+   */
+  void Release(frame_id_t first_frame_id, size_t num_frames);
+
+  /** @return true if the kernel was asked to back the arena with transparent huge pages */
+  bool IsHugePageAdvised() const { return huge_page_advised_; }
+
+ private:
+  /** Start of the frame data. */
+  char *data_;
+  /** Length of the mapping that starts at data_. */
+  size_t mapped_size_;
+  bool huge_page_advised_{false};
+};
+
+}  // namespace bustub
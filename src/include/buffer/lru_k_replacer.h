@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward k-distance, i.e. the time since its k-th most recent access, is
+ * the largest. A frame with fewer than k recorded accesses has a backward k-distance of +inf; when several frames have
+ * +inf, the one with the oldest recorded access is evicted first. A page that is touched once by a sequential scan
+ * therefore goes before a page that has been looked up repeatedly.
+ *
+ * Accesses that follow the previous access to the same frame within the correlated reference window are treated as
+ * one reference: they refresh the last access time but do not add to the history. A frame is not evicted while it is
+ * inside its correlated reference window unless no other frame can be evicted.
+ *
+ * Evictable frames are kept ordered by their backward k-distance. Only the frames accessed within the last
+ * correlated_window accesses can be inside their window, so a victim is found after skipping at most that many.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_frames the maximum number of frames the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered per frame
+   * @param correlated_window accesses closer than this many ticks to the previous one count as one reference
+   */
+  explicit LRUKReplacer(size_t num_frames, size_t k = LRUK_REPLACER_K, size_t correlated_window = 0);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  std::vector<frame_id_t> PeekVictims(size_t max_frames) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    /** Timestamps of the last (at most) k uncorrelated accesses, oldest first. */
+    std::list<size_t> history_;
+    /** Timestamp of the last access, correlated or not. */
+    size_t last_access_{0};
+    /** True if the frame is tracked by the replacer. */
+    bool in_use_{false};
+    /** True if the frame may be evicted. */
+    bool evictable_{false};
+  };
+
+  /**
+   * Orders evictable frames by (finite distance, timestamp). The smallest key that is not inside its correlated
+   * reference window is the next victim.
+   */
+  using EvictionKey = std::pair<bool, size_t>;
+
+  /** @return the eviction key of a frame. The latch must be held. */
+  EvictionKey GetEvictionKey(const FrameInfo &info) const;
+
+  /** @return true if the last access to a frame is inside its correlated reference window. The latch must be held. */
+  bool IsCorrelated(const FrameInfo &info) const;
+
+  /**
+   * @return up to max_frames evictable frames in eviction order: those outside their correlated reference window
+   * first. The latch must be held.
+   */
+  std::vector<frame_id_t> FindVictims(size_t max_frames) const;
+
+  /** Forgets everything about a frame. The latch must be held. */
+  void ResetFrame(frame_id_t frame_id);
+
+  std::vector<FrameInfo> frames_;
+  size_t k_;
+  size_t correlated_window_;
+  /** Logical clock, advanced on every recorded access. */
+  size_t current_timestamp_{0};
+  /** Evictable frames, ordered by eviction key. */
+  std::set<std::pair<EvictionKey, frame_id_t>> evictable_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager is a read-only buffer pool for replicas that only serve queries. It maps the db file into
+ * memory, and FetchPage returns a Page whose data points into the mapping, so a fetch neither reads nor copies the
+ * page. Which pages stay in memory is left to the page cache of the kernel.
+ *
+ * The mapping covers the db file as it is when the buffer pool is created. Writes are rejected: NewPage and DeletePage
+ * fail, and UnpinPage of a dirty page returns false. The page data is mapped read-only, so writing to it crashes
+ * instead of silently changing a page that is never written back.
+ *
+ * Page objects are created the first time their page is fetched and live as long as the buffer pool. Fetching and
+ * unpinning do not take a latch.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new MmapBufferPoolManager over the current content of the db file.
+   * @param disk_manager the disk manager of the db file, which must not be written while the buffer pool is in use
+   */
+  explicit MmapBufferPoolManager(DiskManager *disk_manager);
+
+  /** Unmaps the db file. No page may be in use any more. */
+  ~MmapBufferPoolManager() override;
+
+  /** Asks the kernel to read the pages ahead of their use. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Normal) override;
+
+  /** @return the number of pages in the mapping, which can all be fetched at once */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /** The size is that of the mapping, so resizing always fails. */
+  bool Resize(size_t new_pool_size) override { return false; }
+
+  /** The kernel decides which pages are resident, so there is nothing to save. */
+  void SaveResidentPages(const std::string &file_name) override {}
+
+  /** The kernel decides which pages are resident, so there is nothing to load. */
+  void WarmUp(const std::string &file_name) override {}
+
+ protected:
+  /**
+   * Fetch the requested page from the mapping.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
+   * @return the page, or nullptr if it is not in the db file
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page was modified, which is rejected
+   * @return false if the page is dirty or its pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Pages are never dirty, so there is nothing to flush.
+   * @param page_id id of page to be flushed
+   * @return false if the page is not in the db file, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /** New pages cannot be written. @return nullptr */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /** Pages cannot be deleted. @return false */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /** Pages are never dirty, so there is nothing to flush. */
+  void FlushAllPagesImpl() override {}
+
+ private:
+  /** @return the Page over the given page of the mapping, created on first use */
+  Page *GetPage(page_id_t page_id);
+
+  /** Start of the mapping of the db file. */
+  const char *data_;
+  /** Size of the mapping in bytes. */
+  size_t mapped_size_;
+  /** Number of pages in the mapping. */
+  size_t num_pages_;
+  /** The Page of every page id, nullptr until the page is first fetched. */
+  std::unique_ptr<std::atomic<Page *>[]> pages_;
+};
+
+}  // namespace bustub
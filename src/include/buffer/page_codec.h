@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/buffer/page_codec.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * PageCodec is a small LZ77 compressor in the spirit of LZ4, fast enough to run on every eviction.
+ *
+ * The output is a list of sequences. Each sequence starts with a token byte whose high nibble is the number of
+ * literals and whose low nibble is the match length minus MIN_MATCH. A nibble of 15 is followed by more length bytes,
+ * added up until one is below 255. Then come the literals, and then the offset of the match as two little-endian
+ * bytes. The last sequence has literals only.
+ */
+class PageCodec {
+ public:
+  /**
+   * Compresses a buffer.
+   * @param src the data to compress
+   * @param size the size of the data, at most 64 KB
+   * @param[out] dst output buffer
+   * @param capacity the size of the output buffer
+   * @return the size of the compressed data, 0 if it does not fit in capacity
+   */
+  static size_t Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+  /**
+   * Decompresses data produced by Compress.
+   * @param src the compressed data
+   * @param size the size of the compressed data
+   * @param[out] dst output buffer
+   * @param capacity the size of the output buffer
+   * @return the size of the decompressed data, 0 if the input is malformed or does not fit in capacity
+   */
+  static size_t Decompress(const char *src, size_t size, char *dst, size_t capacity);
+
+ private:
+  /** Shortest match worth encoding. */
+  static constexpr size_t MIN_MATCH = 4;
+  /** Largest distance a match can reach back. */
+  static constexpr size_t MAX_OFFSET = 65535;
+  /** log2 of the number of entries in the match finder's hash table. */
+  static constexpr int HASH_BITS = 12;
+};
+
+}  // namespace bustub
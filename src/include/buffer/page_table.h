@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of resident pages to their frames.
+ *
+ * It is an open-addressing hash table with a fixed number of buckets, sized from the number of frames so that it is
+ * at most half full. Every bucket fills one cache line and holds a few (page id, frame id) pairs, each packed into a
+ * single 64-bit atomic, so a lookup touches one cache line in the common case and never sees a torn entry. An entry
+ * that does not fit in its home bucket goes to the next bucket with a free slot, and every bucket it skips counts it
+ * in its overflow counter. A lookup stops at the first bucket that has no overflow, so erasing needs no tombstones.
+ *
+ * Find is lock-free and may run concurrently with writers. Insert and Erase must be serialized by the caller.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param capacity the maximum number of entries, i.e. the number of frames
+   */
+  explicit PageTable(size_t capacity);
+
+  /**
+   * Looks up a page. Lock-free.
+   * @param page_id id of the page
+   * @param[out] frame_id frame of the page, if it was found
+   * @return true if the page was found, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /** @return true if the page is in the table. Lock-free. */
+  bool Contains(page_id_t page_id) const {
+    frame_id_t frame_id;
+    return Find(page_id, &frame_id);
+  }
+
+  /**
+   * Adds a page that is not in the table yet. Writers must be serialized.
+   * @param page_id id of the page
+   * @param frame_id frame of the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a page. Writers must be serialized.
+   * @param page_id id of the page
+   * @return true if the page was in the table, false otherwise
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of entries */
+  size_t Size() const { return size_.load(); }
+
+ private:
+  /** Slots per bucket, so that a bucket with its overflow counter fits in one cache line. */
+  static constexpr size_t SLOTS_PER_BUCKET = 7;
+  /** Value of a free slot. Page ids are never negative, so no entry packs to this. */
+  static constexpr uint64_t EMPTY_SLOT = ~0ULL;
+
+  struct alignas(64) Bucket {
+    std::atomic<uint64_t> slots_[SLOTS_PER_BUCKET];
+    /** Number of entries stored past this bucket whose home bucket is this one or one before it. */
+    std::atomic<uint32_t> overflow_;
+  };
+  static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t GetPageId(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t GetFrameId(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the bucket a page hashes to */
+  size_t HomeBucket(page_id_t page_id) const;
+
+  size_t num_buckets_;
+  std::unique_ptr<Bucket[]> buckets_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace bustub
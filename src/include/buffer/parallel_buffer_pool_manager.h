@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards pages across several BufferPoolManagerInstances by page id. Every instance has its
+ * own frames, free list, replacer and latch, so operations on pages owned by different instances do not contend.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param max_pool_size the largest size Resize may grow each instance to, 0 for pool_size
+   * @param correlated_window correlated reference window of LRU-K replacers, in accesses
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0, size_t correlated_window = LRUK_CORRELATED_WINDOW);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the sum of the pool sizes of all instances */
+  size_t GetPoolSize() override;
+
+  /**
+   * Spreads the new size evenly over the instances and resizes each of them in turn.
+   * @param new_pool_size the new total number of frames
+   * @return false if some instance would end up with no frames or more than its max_pool_size, true otherwise
+   */
+  bool Resize(size_t new_pool_size) override;
+
+  /**
+   * Writes the resident pages of all instances to one file. The lists of the instances are interleaved, so that the
+   * most recently used pages of every instance come first.
+   * @param file_name the file to write
+   */
+  void SaveResidentPages(const std::string &file_name) override;
+
+  /**
+   * Starts the warmup of every instance with the pages it owns.
+   * @param file_name the file written by SaveResidentPages
+   */
+  void WarmUp(const std::string &file_name) override;
+
+  /** Waits until the warmups of all instances have finished. */
+  void WaitForWarmUp();
+
+  /**
+   * Hands every page to the instance that owns it, one batch per instance.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type how the pages are going to be used
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Normal) override;
+
+  /** @return the number of BufferPoolManagerInstances */
+  size_t GetNumInstances() { return instances_.size(); }
+
+  /**
+   * Starts the background writer of every instance.
+   * @param dirty_ratio share of each instance that may stay dirty
+   * @param max_pages maximum number of pages written per round by each instance
+   */
+  void StartBackgroundWriter(double dirty_ratio = BG_WRITER_DIRTY_RATIO, size_t max_pages = BG_WRITER_MAX_PAGES);
+
+  /** Stops the background writer of every instance. */
+  void StopBackgroundWriter();
+
+  /**
+   * Enables the compressed cache of every instance, giving each an equal share of the capacity.
+   * @param capacity the largest number of bytes the compressed pages of all instances may take up
+   */
+  void EnableCompressedCache(size_t capacity);
+
+  /** @return the counters of the compressed caches, summed over all instances */
+  CompressedCacheStats GetCompressedCacheStats();
+
+  /** @return the number of dirty victims written back by FetchPage or NewPage, over all instances */
+  uint64_t GetNumForegroundWrites();
+
+  /** @return the number of pages written back by the background writers, over all instances */
+  uint64_t GetNumBackgroundWrites();
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool. The page id is allocated first and the page is created in the instance
+   * that owns that id, so this fails if that instance has every frame pinned.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool, on a free page of the disk close to the hint or in the extent of the owner.
+   * @param[out] page_id id of created page
+   * @param hint id of the page the new page is used with, or INVALID_PAGE_ID
+   * @param owner id of the table or index the page belongs to, or INVALID_OWNER_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageNearImpl(page_id_t *page_id, page_id_t hint, owner_id_t owner) override;
+
+  /**
+   * Gives up the extent of an owner on the disk manager.
+   * @param owner id of the table or index
+   */
+  void ReleaseOwnerImpl(owner_id_t owner) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The individual buffer pool instances, indexed by page_id % num_instances. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Pointer to the disk manager, used to allocate page ids. */
+  DiskManager *disk_manager_;
+};
+}  // namespace bustub
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +48,28 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that the frame was accessed. Called by the buffer pool on every fetch, not only when the pin count
+   * goes from zero to one. Policies that only look at Pin/Unpin can ignore it.
+   * @param frame_id the id of the frame that was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Removes a frame and everything known about it, e.g. when its page is deleted and the frame goes back to the free
+   * list. Policies without per-frame history can treat this as a pin.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Lists the frames that Victim would return next, without removing them. Used by the background writer to clean
+   * pages before they are evicted. Policies that cannot tell return an empty list.
+   * @param max_frames the maximum number of frames to return
+   * @return the next victims, first victim first
+   */
+  virtual std::vector<frame_id_t> PeekVictims(size_t max_frames) { return {}; }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
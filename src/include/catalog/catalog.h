@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_set.h"
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
@@ -25,12 +26,19 @@ using index_oid_t = uint32_t;
  * Metadata about a table.
  */
 struct TableMetadata {
-  TableMetadata(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid)
-      : schema_(std::move(schema)), name_(std::move(name)), table_(std::move(table)), oid_(oid) {}
+  TableMetadata(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid,
+                std::string pool_name = "")
+      : schema_(std::move(schema)),
+        name_(std::move(name)),
+        table_(std::move(table)),
+        oid_(oid),
+        pool_name_(std::move(pool_name)) {}
   Schema schema_;
   std::string name_;
   std::unique_ptr<TableHeap> table_;
   table_oid_t oid_;
+  /** Name of the buffer pool the table is bound to, empty for the default pool. */
+  std::string pool_name_;
 };
 
 /**
@@ -38,19 +46,22 @@ struct TableMetadata {
  */
 struct IndexInfo {
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, std::string pool_name = "")
       : key_schema_(std::move(key_schema)),
         name_(std::move(name)),
         index_(std::move(index)),
         index_oid_(index_oid),
         table_name_(std::move(table_name)),
-        key_size_(key_size) {}
+        key_size_(key_size),
+        pool_name_(std::move(pool_name)) {}
   Schema key_schema_;
   std::string name_;
   std::unique_ptr<Index> index_;
   index_oid_t index_oid_;
   std::string table_name_;
   const size_t key_size_;
+  /** Name of the buffer pool the index is bound to, empty for the default pool. */
+  std::string pool_name_;
 };
 
 /**
@@ -64,26 +75,33 @@ class Catalog {
    * @param bpm the buffer pool manager backing tables created by this catalog
    * @param lock_manager the lock manager in use by the system
    * @param log_manager the log manager in use by the system
+   * @param buffer_pools named buffer pools that tables and indexes can be bound to, nullptr if there are none
    */
-  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
-      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
+  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager,
+          BufferPoolSet *buffer_pools = nullptr)
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager}, buffer_pools_{buffer_pools} {}
 
   /**
    * Create a new table and return its metadata.
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param pool_name the named buffer pool that holds the pages of the table, empty for the default pool
    * @return a pointer to the metadata of the new table
+   * @throws std::out_of_range if there is no buffer pool with that name
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             const std::string &pool_name = "") {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
+    BufferPoolManager *bpm = GetBufferPool(pool_name);
 
     table_oid_t table_oid = next_table_oid_;
     ++next_table_oid_;
 
-    std::unique_ptr<TableHeap> table_heap = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    std::unique_ptr<TableHeap> table_heap = std::make_unique<TableHeap>(bpm, lock_manager_, log_manager_, txn);
 
-    tables_[table_oid] = std::make_unique<TableMetadata>(schema, table_name, std::move(table_heap), table_oid);
+    tables_[table_oid] =
+        std::make_unique<TableMetadata>(schema, table_name, std::move(table_heap), table_oid, pool_name);
     names_[table_name] = table_oid;
     index_names_[table_name] = std::unordered_map<std::string, index_oid_t>();
 
@@ -117,30 +135,43 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param pool_name the named buffer pool that holds the pages of the index, empty for the default pool. B+trees
+   * record their root in the header page, which must only be fetched through one pool, so all indexes share a pool.
+   * @param compress_keys true to store the keys in compressed pages, which hold more of them and so make the index
+   * shallower
    * @return a pointer to the metadata of the new table
+   * @throws std::out_of_range if there is no buffer pool with that name
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
+                         size_t keysize, const std::string &pool_name = "", bool compress_keys = false) {
     BUSTUB_ASSERT(index_names_.count(table_name) != 0, "The table do not exist!");
     BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique!");
+    BufferPoolManager *bpm = GetBufferPool(pool_name);
+    BUSTUB_ASSERT(index_bpm_ == nullptr || index_bpm_ == bpm, "All indexes should be bound to the same pool!");
+    index_bpm_ = bpm;
 
     index_oid_t index_oid = next_index_oid_;
     ++next_index_oid_;
 
     auto metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
-    std::unique_ptr<Index> index(new BPlusTreeIndex<KeyType, ValueType, KeyComparator>(metadata, bpm_));
-    indexes_[index_oid] =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto *tree_index = new BPlusTreeIndex<KeyType, ValueType, KeyComparator>(metadata, bpm, compress_keys);
+    std::unique_ptr<Index> index(tree_index);
+    indexes_[index_oid] = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid,
+                                                      table_name, keysize, pool_name);
     index_names_[table_name][index_name] = index_oid;
 
     auto table = GetTable(table_name)->table_.get();
-    // add index for every tuple
+    // sort the entries of every tuple and build the index from them bottom-up
+    ExternalSorter<KeyType, ValueType, KeyComparator> sorter(bpm, KeyComparator(metadata->GetKeySchema()));
     for (auto it = table->Begin(txn); it != table->End(); ++it) {
-      indexes_[index_oid].get()->index_->InsertEntry(it->KeyFromTuple(schema, key_schema, key_attrs), it->GetRid(),
-                                                     txn);
+      KeyType index_key;
+      index_key.SetFromKey(it->KeyFromTuple(schema, key_schema, key_attrs));
+      sorter.Add(index_key, it->GetRid());
     }
+    sorter.Sort();
+    tree_index->BulkLoad(&sorter);
 
     return indexes_[index_oid].get();
   }
@@ -161,6 +192,21 @@ class Catalog {
     return indexes_[index_oid].get();
   }
 
+  /**
+   * @param pool_name name of a buffer pool, empty for the default pool
+   * @return the buffer pool
+   * @throws std::out_of_range if there is no buffer pool with that name
+   */
+  BufferPoolManager *GetBufferPool(const std::string &pool_name) {
+    if (pool_name.empty()) {
+      return bpm_;
+    }
+    if (buffer_pools_ == nullptr) {
+      throw std::out_of_range("The buffer pool does not exist!");
+    }
+    return buffer_pools_->GetPool(pool_name);
+  }
+
   std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
     if (index_names_.count(table_name) == 0) {
       throw std::out_of_range("The table do not exist");
@@ -179,6 +225,10 @@ class Catalog {
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
+  /** Named buffer pools, nullptr if there are none. */
+  BufferPoolSet *buffer_pools_;
+  /** The pool of the indexes created so far, nullptr if there are none. */
+  BufferPoolManager *index_bpm_{nullptr};
 
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
@@ -12,7 +12,7 @@
 
 #include <string>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -32,7 +32,10 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    // reload the pages that were resident at the last shutdown
+    warm_file_name_ = db_file_name.substr(0, db_file_name.rfind('.')) + ".warm";
+    buffer_pool_manager_->WarmUp(warm_file_name_);
 
     // txn related
     lock_manager_ = new LockManager();
@@ -48,6 +51,7 @@ class BustubInstance {
     }
     delete checkpoint_manager_;
     delete log_manager_;
+    buffer_pool_manager_->SaveResidentPages(warm_file_name_);
     delete buffer_pool_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -55,11 +59,12 @@ class BustubInstance {
   }
 
   DiskManager *disk_manager_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPoolManagerInstance *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  std::string warm_file_name_;
 };
 
 }  // namespace bustub
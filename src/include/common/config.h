@@ -27,19 +27,36 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running background writer of the buffer pool writes back dirty pages every BG_WRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bg_writer_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
+static constexpr int INVALID_OWNER_ID = -1;                                   // pages without an extent owner
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int LRUK_CORRELATED_WINDOW = 0;                              // lru-k accesses merged into one
+static constexpr int SEQ_SCAN_RING_SIZE = 8;                                  // frames recycled by sequential scans
+static constexpr int BULK_WRITE_RING_SIZE = 32;                               // frames recycled by bulk writes
+static constexpr int BG_WRITER_MAX_PAGES = 16;                                // pages written per background round
+static constexpr double BG_WRITER_DIRTY_RATIO = 0.1;                          // share of the pool allowed to stay dirty
+static constexpr int PREFETCH_BATCH_SIZE = 16;                                // pages prefetched at once by index scans
+static constexpr int WARMUP_READ_PAGES = 64;                                  // largest read issued by a warm restart
+static constexpr int DISK_SCHEDULER_QUEUE_DEPTH = 64;                         // io_uring submission queue entries
+static constexpr int DISK_SCHEDULER_NUM_WORKERS = 4;                          // threads of the disk scheduler fallback
+static constexpr int INDEX_SORT_RUN_PAGES = 4096;                             // pages of pairs sorted in memory
+static constexpr double INDEX_FILL_FACTOR = 0.9;                              // share of a page filled by bulk loads
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
+using owner_id_t = int32_t;    // extent owner id type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
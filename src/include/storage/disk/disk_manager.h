@@ -13,9 +13,18 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -24,42 +33,90 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on a file descriptor, so ReadPage, ReadPages, WritePage and
+ * WritePages can be called from several threads at once without serializing each other.
+ *
+ * With direct I/O, the db file is opened with O_DIRECT, so pages bypass the page cache of the operating system and are
+ * only cached once, in the buffer pool. Direct I/O needs buffers aligned to PAGE_SIZE. Buffers from AllocateAligned
+ * and the frames of a buffer pool are aligned; others are copied through an aligned buffer, which is slower.
+ *
+ * Allocated pages are tracked in a free-space map: a bitmap with one bit per page, kept in reserved pages of the db
+ * file. Each page of the map is stored right before the FSM_PAGE_BITS pages it tracks, so page ids stay dense and the
+ * file offset of a page is given by PageOffset. Deallocated pages are reused before the file grows, lowest page id
+ * first or close to a hint, which keeps the file compact. Changes to the map are kept in memory and written by
+ * WritePages, which syncs them together with the pages, and ShutDown. A new page is the exception: before it is first
+ * written, the map is written and synced, so that a page on disk is never free in the map after a crash.
+ *
+ * Pages of a table or an index can be allocated in extents instead: EXTENT_SIZE contiguous pages reserved for their
+ * owner, so that a scan of the object reads runs of neighbouring pages. Reservations are kept in memory only, so the
+ * pages of an extent that were not allocated before a restart are free again after it.
+ *
+ * Other storage backends derive from DiskManager and override the I/O, see DiskManagerMemory and DiskManagerSlow.
  */
 class DiskManager {
+  // The io_uring backend of the disk scheduler does the I/O on the descriptor itself and keeps the counters and the
+  // file size up to date.
+  friend class DiskScheduler;
+
  public:
+  /** Frees an aligned buffer. */
+  struct AlignedDeleter {
+    void operator()(char *data) const { std::free(data); }  // NOLINT
+  };
+  /** A buffer from AllocateAligned. */
+  using AlignedBuffer = std::unique_ptr<char[], AlignedDeleter>;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the page cache with O_DIRECT. Where the file system refuses O_DIRECT, the file is
+   * opened for buffered I/O instead, see IsDirectIo.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
-  ~DiskManager() = default;
+  virtual ~DiskManager() = default;
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. The page reaches the operating system, not necessarily the disk.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Write many pages to the database file and make them durable. The pages are sorted by id, runs of consecutive ids
+   * are written with one vectored write each, and the file is synced once at the end.
+   * @param pages ids and raw data of the pages
+   */
+  virtual void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. A page past the end of the file reads as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Read consecutive pages from the database file with a single read. Pages past the end of the file read as zeros.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to read
+   * @param[out] page_data output buffer of num_pages * PAGE_SIZE bytes
+   */
+  virtual void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data);
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,28 +125,110 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  virtual bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk. A deallocated page is reused if there is one, otherwise the file grows by a page.
+   * @param hint a page the new page is used together with, or INVALID_PAGE_ID. A free page within FSM_HINT_DISTANCE of
+   * the hint is taken first, the lowest free page otherwise.
+   * @param owner id of the table or index the page belongs to, or INVALID_OWNER_ID. Pages of an owner come from the
+   * extent reserved for it, and a new extent is reserved when that one is full, right after it if possible. The hint
+   * is ignored.
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  virtual page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID, owner_id_t owner = INVALID_OWNER_ID);
 
   /**
-   * Deallocate a page on disk.
+   * Gives up the extent reserved for an owner that allocates no more pages, so that its free pages can be taken by
+   * others. Its allocated pages stay allocated.
+   * @param owner id of the table or index
+   */
+  virtual void ReleaseOwner(owner_id_t owner);
+
+  /**
+   * Gives up the extents of an owner in every disk manager, for owners that may outlive their disk manager, such as a
+   * table heap or a B+tree whose buffer pool is deleted first. Each disk manager releases the owner the next time it
+   * allocates a page.
+   * @param owner id of the table or index
+   */
+  static void RetireOwner(owner_id_t owner);
+
+  /**
+   * Deallocate a page on disk, so that it can be allocated again. Pages that are not allocated are ignored.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(page_id_t page_id);
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  virtual bool IsAllocated(page_id_t page_id);
+
+  /**
+   * @return the number of pages below the end of the file that are not allocated, either deallocated ones or unused
+   * pages of reserved extents
+   */
+  virtual size_t GetNumFreePages();
+
+  /** Number of pages one page of the free-space map keeps track of. */
+  static constexpr size_t FSM_PAGE_BITS = PAGE_SIZE * 8;
+  /** How far from its hint a free page may be to be preferred over the lowest free page. */
+  static constexpr page_id_t FSM_HINT_DISTANCE = 64;
+  /** Number of pages in an extent. An extent is one word of the free-space map, aligned to its size. */
+  static constexpr page_id_t EXTENT_SIZE = 64;
+
+  /** @return the offset of a page in the db file, past the pages of the free-space map before it */
+  static uint64_t PageOffset(page_id_t page_id) {
+    return (static_cast<uint64_t>(page_id) + page_id / FSM_PAGE_BITS + 1) * PAGE_SIZE;
+  }
+
+  /** @return the number of pages, not counting pages of the free-space map, that lie wholly in the first size bytes */
+  static uint64_t NumPagesIn(uint64_t size) {
+    uint64_t num_file_pages = size / PAGE_SIZE;
+    return num_file_pages - (num_file_pages + FSM_PAGE_BITS) / (FSM_PAGE_BITS + 1);
+  }
 
   /** @return the number of disk flushes */
-  int GetNumFlushes() const;
+  virtual int GetNumFlushes() const;
 
   /** @return true iff the in-memory content has not been flushed yet */
-  bool GetFlushState() const;
+  virtual bool GetFlushState() const;
+
+  /**
+   * Maps the db file into memory read-only, for MmapBufferPoolManager. The mapping covers the file as it is now and
+   * stays valid after ShutDown. It must be released with UnmapDbFile.
+   * @param[out] size size of the mapping in bytes, the size of the file rounded down to whole pages. A page is found
+   * at its PageOffset in the mapping.
+   * @return the start of the mapping, or nullptr if the file is empty or cannot be mapped
+   */
+  virtual const char *MapDbFile(size_t *size);
+
+  /**
+   * Releases a mapping made by MapDbFile.
+   * @param data the start of the mapping
+   * @param size size of the mapping in bytes
+   */
+  static void UnmapDbFile(const char *data, size_t size);
+
+  /** @return true if the db file is read and written with O_DIRECT */
+  virtual bool IsDirectIo() const { return direct_io_; }
+
+  /**
+   * Allocates a buffer that direct I/O can read into and write from without a copy.
+   * @param size size of the buffer in bytes, a multiple of PAGE_SIZE
+   * @return the buffer, aligned to PAGE_SIZE
+   */
+  static AlignedBuffer AllocateAligned(size_t size);
+
+  /**
+   * @return the size of the database file in bytes, not counting the pages of the free-space map, kept in memory and
+   * updated by the writes
+   */
+  virtual uint64_t GetDbFileSize() const { return db_file_size_; }
 
   /** @return the number of disk writes */
-  int GetNumWrites() const;
+  virtual int GetNumWrites() const;
+
+  /** @return the number of reads from the database file, counting a ReadPages call as one */
+  virtual int GetNumReads() const;
 
   /**
    * Sets the future which is used to check for non-blocking flushes.
@@ -100,19 +239,127 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without files, for backends that keep the pages elsewhere. The free-space map is kept in
+   * memory only.
+   */
+  DiskManager();
+
+  /** Grows the cached file size to cover a write of pages that ended at the given size, see GetDbFileSize. */
+  void ExtendDbFileSize(uint64_t end);
+
+  // size of the db file, so that reads do not have to stat the file
+  std::atomic<uint64_t> db_file_size_{0};
+  int num_flushes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_reads_{0};
+  bool flush_log_{false};
+  std::future<void> *flush_log_f_{nullptr};
+
  private:
   int GetFileSize(const std::string &file_name);
+
+  /** @return true if direct I/O on the buffer needs a copy through an aligned buffer */
+  bool NeedsBounce(const char *data) const {
+    return direct_io_ && reinterpret_cast<uintptr_t>(data) % PAGE_SIZE != 0;
+  }
+
+  /**
+   * Opens the db file with O_DIRECT and checks that the file system accepts direct reads.
+   * @return true if the file is open for direct I/O, false if the file system refuses O_DIRECT with EINVAL, in which
+   * case the descriptor is closed
+   * @throws Exception if the file cannot be opened or read for any other reason
+   */
+  bool OpenDirect(const std::string &db_file);
+
+  /**
+   * Writes a buffer at an offset of the db file, retrying after short writes and interrupts.
+   * @return false on an I/O error
+   */
+  bool WriteFully(const char *data, size_t size, uint64_t offset);
+
+  /**
+   * Reads from the db file at an offset, retrying after short reads and interrupts, and zeroes what lies past the end
+   * of the file.
+   * @return false on an I/O error
+   */
+  bool ReadFully(char *data, size_t size, uint64_t offset);
+
+  /**
+   * Loads the free-space map from the db file. fsm_latch_ need not be held, as it is only called by the constructor.
+   */
+  void LoadFreeSpaceMap();
+
+  /** @return a free page below next_page_id_ close to the hint or the lowest one, or INVALID_PAGE_ID. */
+  page_id_t FindFreePage(page_id_t hint);
+
+  /** @return true if the bit of the page is set in the free-space map */
+  bool TestFsmBit(page_id_t page_id) const {
+    return (fsm_[page_id / 64] >> (page_id % 64) & 1) != 0;  // NOLINT
+  }
+
+  /** @return true if the page is allocated or in an extent reserved for an owner */
+  bool IsTaken(page_id_t page_id) const { return TestFsmBit(page_id) || reserved_extents_[page_id / EXTENT_SIZE]; }
+
+  /**
+   * Reserves an extent that has no allocated pages, growing the file if there is none.
+   * @param preferred_extent the extent to take if it is free, e.g. the one after the last extent of the owner
+   * @return the index of the extent, which is also its word in the free-space map
+   */
+  size_t ReserveExtent(size_t preferred_extent);
+
+  /** Grows the free-space map to cover the given number of pages, in whole pages of the map. */
+  void ResizeFsm(size_t num_pages);
+
+  /** Writes the pages of the free-space map that changed since the last call. */
+  void FlushFreeSpaceMap();
+
+  /** Gives up the extent reserved for an owner, if it has one. fsm_latch_ must be held. */
+  void ReleaseExtentOf(owner_id_t owner);
+
+  /** Releases the owners retired with RetireOwner since the last call. fsm_latch_ must be held. */
+  void ReleaseRetiredOwners();
+
+  /** Writes the pages of the free-space map that changed since the last call. fsm_latch_ must be held. */
+  void WriteFsmPages();
+
+  /** Writes and syncs the free-space map if the page was allocated since the map was last synced. */
+  void SyncAllocation(page_id_t page_id);
+
+  /** @return the offset in the db file of a page of the free-space map */
+  static uint64_t FsmPageOffset(size_t fsm_page) { return fsm_page * (FSM_PAGE_BITS + 1) * PAGE_SIZE; }
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file
+  int db_fd_{-1};
+  // true if db_fd_ was opened with O_DIRECT
+  bool direct_io_{false};
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  // protects the free-space map and next_page_id_
+  std::mutex fsm_latch_;
+  // one bit per page, set if the page is allocated, rounded up to whole pages of the map
+  std::vector<uint64_t> fsm_;
+  // pages of the map changed since they were last written, written by WritePages and ShutDown
+  std::set<size_t> dirty_fsm_pages_;
+  // pages allocated since the map was last synced, which must not be written before it is
+  std::unordered_set<page_id_t> unsynced_allocations_;
+  // the size of unsynced_allocations_, so that writes need not take fsm_latch_ when it is empty
+  std::atomic<size_t> num_unsynced_allocations_{0};
+  // no page below this one is free and outside reserved extents
+  page_id_t fsm_search_start_{0};
+  // one flag per extent, set while the extent is reserved for an owner
+  std::vector<bool> reserved_extents_;
+  // the extent each owner allocates its pages from
+  std::unordered_map<owner_id_t, size_t> owner_extents_;
+  // the number of owners retired with RetireOwner that were released here
+  size_t num_released_retired_owners_{0};
+  // no extent below this one is free and unreserved
+  size_t extent_search_start_{0};
+  // the file grows beyond this page when there is no free page
+  page_id_t next_page_id_{0};
 };
 
 }  // namespace bustub
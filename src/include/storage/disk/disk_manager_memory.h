@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.h
+//
+// Identification: src/include/storage/disk/disk_manager_memory.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMemory keeps the pages and the log in memory instead of in files, for tests and benchmarks that do not
+ * need the data to outlive the process. Everything is lost when it is destroyed.
+ *
+ * Pages are read and written with a memcpy, and several threads can do so at once. Page allocation and the counters
+ * work as with files.
+ */
+class DiskManagerMemory : public DiskManager {
+ public:
+  DiskManagerMemory() = default;
+
+  ~DiskManagerMemory() override = default;
+
+  /** There are no files to close. */
+  void ShutDown() override {}
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** Writes the pages. Memory is always durable, so there is nothing to sync. */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  /** There is no file to map. @return nullptr */
+  const char *MapDbFile(size_t *size) override;
+
+ private:
+  /** Copies the data of a page into its slot, adding the slot if the page was never written. */
+  void StorePage(page_id_t page_id, const char *page_data);
+
+  /** @return the page, nullptr if it was never written. The latch must be held. */
+  char *GetPage(page_id_t page_id) const;
+
+  /** Protects the page slots: shared to read or write a page, exclusive to add slots. */
+  mutable std::shared_mutex latch_;
+  /** The data of every page that was written, indexed by page id. */
+  std::vector<std::unique_ptr<char[]>> pages_;
+  /** Protects log_. */
+  std::mutex log_latch_;
+  /** The log records, as they would be in the log file. */
+  std::vector<char> log_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_slow.h
+//
+// Identification: src/include/storage/disk/disk_manager_slow.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Timings of the device that DiskManagerSlow simulates. */
+struct SlowDiskOptions {
+  /** Time from issuing a read of a page, or of a run of pages, to its first byte. */
+  std::chrono::microseconds read_latency_{0};
+  /** Time from issuing a write to the device taking it. */
+  std::chrono::microseconds write_latency_{0};
+  /** Time to make writes durable, paid by the sync of WritePages and by every WriteLog. */
+  std::chrono::microseconds sync_latency_{0};
+  /** Transfer rate in bytes per second, shared by all I/Os. 0 for no limit. */
+  uint64_t bandwidth_{0};
+  /** Number of I/Os the device works on at once, others wait for a slot. 0 for no limit. */
+  size_t queue_depth_{0};
+
+  /** @return the timings of a datacenter NVMe SSD */
+  static SlowDiskOptions Ssd() {
+    return {std::chrono::microseconds(90), std::chrono::microseconds(25), std::chrono::microseconds(500),
+            uint64_t{2} << 30, 0};
+  }
+
+  /** @return the timings of a 7200 rpm hard disk, which seeks for every I/O and serves one at a time */
+  static SlowDiskOptions Hdd() {
+    return {std::chrono::microseconds(8000), std::chrono::microseconds(8000), std::chrono::microseconds(8000),
+            uint64_t{150} << 20, 1};
+  }
+};
+
+/**
+ * DiskManagerSlow wraps another disk manager and delays every I/O as a device with the given latency, bandwidth and
+ * queue depth would, so that the buffer pool, the indexes and recovery can be measured under SSD or HDD timings
+ * without such hardware. Wrapping a DiskManagerMemory gives the timings without touching any file.
+ *
+ * Latencies of concurrent I/Os overlap up to the queue depth, while the bandwidth is shared, so a single thread that
+ * waits for every read sees the latency, and many outstanding reads see the bandwidth. Page allocation and the
+ * counters are those of the wrapped disk manager.
+ */
+class DiskManagerSlow : public DiskManager {
+ public:
+  /**
+   * Creates a new DiskManagerSlow.
+   * @param disk_manager the disk manager that stores the pages, which must outlive this one
+   * @param options the timings to add to every I/O
+   */
+  DiskManagerSlow(DiskManager *disk_manager, SlowDiskOptions options)
+      : disk_manager_(disk_manager), options_(options) {}
+
+  ~DiskManagerSlow() override = default;
+
+  void ShutDown() override { disk_manager_->ShutDown(); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID, owner_id_t owner = INVALID_OWNER_ID) override {
+    return disk_manager_->AllocatePage(hint, owner);
+  }
+
+  void ReleaseOwner(owner_id_t owner) override { disk_manager_->ReleaseOwner(owner); }
+
+  void DeallocatePage(page_id_t page_id) override { disk_manager_->DeallocatePage(page_id); }
+
+  bool IsAllocated(page_id_t page_id) override { return disk_manager_->IsAllocated(page_id); }
+
+  size_t GetNumFreePages() override { return disk_manager_->GetNumFreePages(); }
+
+  int GetNumFlushes() const override { return disk_manager_->GetNumFlushes(); }
+
+  bool GetFlushState() const override { return disk_manager_->GetFlushState(); }
+
+  /** A mapping bypasses the simulated device, so reads through it are not delayed. */
+  const char *MapDbFile(size_t *size) override { return disk_manager_->MapDbFile(size); }
+
+  bool IsDirectIo() const override { return disk_manager_->IsDirectIo(); }
+
+  uint64_t GetDbFileSize() const override { return disk_manager_->GetDbFileSize(); }
+
+  int GetNumWrites() const override { return disk_manager_->GetNumWrites(); }
+
+  int GetNumReads() const override { return disk_manager_->GetNumReads(); }
+
+  /** @return the options this disk manager simulates */
+  const SlowDiskOptions &GetOptions() const { return options_; }
+
+ private:
+  /**
+   * Waits as long as the device would take for an I/O: for a slot in its queue, then for the latency and for the
+   * transfer, which starts when the device is done with earlier transfers.
+   * @param latency the latency of the I/O
+   * @param num_bytes number of bytes to transfer
+   */
+  void Delay(std::chrono::microseconds latency, size_t num_bytes);
+
+  DiskManager *disk_manager_;
+  SlowDiskOptions options_;
+  /** Protects num_in_flight_ and transfer_end_. */
+  std::mutex latch_;
+  /** Signalled when an I/O leaves the queue. */
+  std::condition_variable queue_cv_;
+  /** I/Os the device is working on. */
+  size_t num_in_flight_{0};
+  /** When the device is done with the transfers it was given so far. */
+  std::chrono::steady_clock::time_point transfer_end_{};
+};
+
+}  // namespace bustub
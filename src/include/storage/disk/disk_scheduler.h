@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** A page read or write for the DiskScheduler. */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The page content to write, or the buffer to read the page into. PAGE_SIZE bytes. */
+  char *data_;
+  /** Id of the page. */
+  page_id_t page_id_;
+  /** Set to true once the request is done, false if it failed. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * DiskScheduler queues page reads and writes in front of a DiskManager and runs many of them at once, so that the
+ * latency of outstanding I/Os overlaps. On Linux, requests are submitted in batches through io_uring, with one thread
+ * that submits and reaps. Where io_uring is not available, or cannot be set up, a pool of worker threads runs the
+ * requests with the blocking calls of the DiskManager instead.
+ *
+ * Requests are not ordered with respect to each other. A caller that needs a read to see a write waits for the write
+ * first.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * Creates a new DiskScheduler and starts its threads.
+   * @param disk_manager the disk manager to run the requests on
+   * @param use_io_uring false to always use the worker threads, which backends without a db file always use
+   * @param num_workers number of worker threads if io_uring is not used
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, bool use_io_uring = true,
+                         size_t num_workers = DISK_SCHEDULER_NUM_WORKERS);
+
+  /** Runs the requests that are still queued, then stops the threads. */
+  ~DiskScheduler();
+
+  /**
+   * Queues a request and returns without waiting for it.
+   * @param request the request, whose callback is set once it is done
+   */
+  void Schedule(DiskRequest request);
+
+  /**
+   * Queues many requests at once, which io_uring submits together.
+   * @param requests the requests, whose callbacks are set as they are done
+   */
+  void Schedule(std::vector<DiskRequest> requests);
+
+  /** @return a promise for the callback of a request */
+  std::promise<bool> CreatePromise() { return {}; }
+
+  /**
+   * Reads a page and waits for it.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return false if the read failed
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Writes a page and waits for it.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return false if the write failed
+   */
+  bool WritePage(page_id_t page_id, const char *page_data);
+
+  /** @return true if requests go through io_uring, false if they are run by worker threads */
+  bool UsesIoUring() const { return ring_ != nullptr; }
+
+ private:
+  /** The io_uring instance, only defined where io_uring is available. */
+  struct IoUring;
+
+  /** Body of the io_uring thread: submits queued requests and completes them as the kernel reports them done. */
+  void RunIoUring();
+
+  /** Body of a worker thread: runs queued requests one at a time. */
+  void RunWorker();
+
+  /** Runs a request with the blocking calls of the disk manager and sets its callback. */
+  void RunRequest(DiskRequest *request);
+
+  DiskManager *disk_manager_;
+  /** The io_uring instance, nullptr if the worker threads are used. */
+  std::unique_ptr<IoUring> ring_;
+  /** Protects queue_ and stop_. */
+  std::mutex latch_;
+  /** Signalled when a request is queued or the threads should stop. */
+  std::condition_variable queue_cv_;
+  /** Requests that have not been started yet. */
+  std::deque<DiskRequest> queue_;
+  /** True once the threads should stop after the queue is empty. */
+  bool stop_{false};
+  /** The io_uring thread, or the worker threads. */
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
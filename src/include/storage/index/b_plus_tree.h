@@ -10,11 +10,14 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "storage/index/external_sorter.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -32,6 +35,8 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Optionally store keys in compressed pages, whose leaves share a key
+ *     prefix and whose internal pages hold separators cut short at splits
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +45,14 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool compress_keys = false);
+
+  /**
+   * Retires the owner id of the tree, so that disk managers give up the extent of its pages. The buffer pool may be
+   * gone by now, so it is not used.
+   */
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -51,6 +63,9 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Build this B+ tree bottom-up from sorted pairs, filling pages up to fill_factor. The tree must be empty.
+  auto BulkLoad(EXTERNAL_SORTER_TYPE *sorter, double fill_factor = INDEX_FILL_FACTOR) -> bool;
+
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
@@ -79,6 +94,43 @@ class BPlusTree {
   void StartNewTree(const KeyType &key, const ValueType &value);
   void StartNewRoot(BPlusTreePage *left_node, const KeyType &key, BPlusTreePage *right_node);
 
+  // How FetchRootPage latches the root page.
+  enum class RootLatchMode { READ, WRITE_LEAF, WRITE };
+
+  // Fetch and latch the root page, nullptr if the tree is empty.
+  auto FetchRootPage(RootLatchMode mode) -> Page *;
+
+  // Delete the pages a remove emptied, and old roots that could not be deleted before.
+  void DeletePages(page_id_t old_root_page_id, Transaction *transaction);
+
+  // Find the leaf page for a key with read latches and write latch only the leaf.
+  auto FindLeafPageToWrite(const KeyType &key) -> Page *;
+
+  // Whether a change below a node cannot split it, or cannot make it underflow.
+  auto IsSafeToInsert(BPlusTreePage *node) const -> bool;
+  auto IsSafeToRemove(BPlusTreePage *node) const -> bool;
+  auto GetFillRatio(BPlusTreePage *node) const -> double;
+
+  // The key that parents keep between two neighboring leaves, cut short if keys are compressed.
+  auto Separator(const KeyType &left_key, const KeyType &right_key) -> KeyType;
+
+  // A level of the tree that BulkLoad builds, from left to right. With compressed keys the size of nodes is not known
+  // ahead: each one is filled up to fill_factor_ of its bytes instead.
+  struct BulkLoadLevel {
+    // entries that a node gets
+    int node_size_;
+    // the open node, nullptr before the first one
+    Page *page_;
+    // share of the bytes of a compressed node that it fills
+    double fill_factor_;
+  };
+
+  // A level of leaves or internal nodes for BulkLoad, whose nodes are filled up to fill_factor.
+  auto NewBulkLoadLevel(bool is_leaf, double fill_factor) const -> BulkLoadLevel;
+
+  // Get the open node of a bulk loaded level, opening the next one if it is full.
+  auto BulkLoadNode(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &first_key) -> Page *;
+
   auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
@@ -113,12 +165,23 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // Read without a latch. Only a writer that holds the latch of the root page, or new_tree_latch_ while the tree is
+  // empty, changes it.
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
-  ReaderWriterLatch rwlatch_;
+  // whether new pages are compressed
+  bool compress_keys_;
+  // the extent owner new pages of the tree are allocated for
+  owner_id_t owner_id_{BufferPoolManager::NewOwnerId()};
+  // Taken by inserts into an empty tree, so that only one of them starts the new tree.
+  std::mutex new_tree_latch_;
+  // Replaced roots that are not deleted yet, because a FetchRootPage with a stale id may have them pinned. Only writers
+  // that delete pages take old_roots_latch_.
+  std::vector<page_id_t> old_root_page_ids_;
+  std::mutex old_roots_latch_;
 };
 
 }  // namespace bustub
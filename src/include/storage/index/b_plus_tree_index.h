@@ -25,7 +25,13 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * Creates a new BPlusTreeIndex.
+   * @param metadata the metadata of the index
+   * @param buffer_pool_manager buffer pool that holds the pages of the index
+   * @param compress_keys true to store keys in compressed pages, which hold more of them
+   */
+  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager, bool compress_keys = false);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -33,6 +39,13 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Builds the empty index bottom-up from sorted entries, which is much faster than inserting them one by one.
+   * @param sorter the sorted entries
+   * @param fill_factor share of every page that is filled
+   */
+  void BulkLoad(EXTERNAL_SORTER_TYPE *sorter, double fill_factor = INDEX_FILL_FACTOR);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
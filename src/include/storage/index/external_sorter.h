@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSorter sorts (key, value) pairs by key for building an index bottom-up, when there may be more of them
+ * than fit in memory.
+ *
+ * Pairs are collected in memory up to the run size. A full run is sorted and written to pages of the buffer pool,
+ * which write it to disk as they are evicted. Once all pairs are added, the runs are merged. Only one page of each
+ * run is kept in memory during the merge, and no page stays pinned.
+ *
+ * Keys are unique in the output, as in the index: of the pairs with the same key, only the first one added is kept.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  /**
+   * Creates a new ExternalSorter.
+   * @param buffer_pool_manager buffer pool that holds the runs which do not fit in memory
+   * @param comparator comparator for keys
+   * @param run_size number of pairs that are sorted in memory at once
+   */
+  ExternalSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                 size_t run_size = INDEX_SORT_RUN_PAGES * PAIRS_PER_PAGE);
+
+  /** Deletes the pages of the runs that were not read yet and gives up their extent. */
+  ~ExternalSorter();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /**
+   * Adds a pair. Must not be called after Sort.
+   * @param key the key
+   * @param value the value
+   */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Sorts the pairs added so far and drops duplicate keys, so that they can be read with Next. */
+  void Sort();
+
+  /** @return the number of pairs that Next returned so far */
+  auto GetNumPairs() const -> size_t { return num_pairs_; }
+
+  /** @return the number of runs that were written to the buffer pool */
+  auto GetNumRuns() const -> size_t { return runs_.size(); }
+
+  /**
+   * Reads the next pair in key order. The pages of a run are deleted as they are read.
+   * @param[out] pair the pair
+   * @return false if all pairs were read
+   */
+  auto Next(MappingType *pair) -> bool;
+
+  /** Number of pairs in a page of a run. */
+  static constexpr size_t PAIRS_PER_PAGE = PAGE_SIZE / sizeof(MappingType);
+
+ private:
+  /** A sorted run in pages of the buffer pool. */
+  struct Run {
+    std::vector<page_id_t> page_ids_;
+    size_t num_pairs_;
+  };
+
+  /** The position of the merge in a run. */
+  struct Cursor {
+    /** Index of the next page of the run to read. */
+    size_t next_page_;
+    /** Number of pairs of the run not read into pairs_ yet. */
+    size_t num_unread_;
+    /** The pairs of the current page. */
+    std::vector<MappingType> pairs_;
+    /** Position of the next pair in pairs_. */
+    size_t position_;
+  };
+
+  /** Sorts the pairs in memory, keeping the first pair added of each key. */
+  void SortBuffer();
+
+  /** Sorts the pairs in memory and writes them to the buffer pool as a new run. */
+  void WriteRun();
+
+  /** Starts the merge of all runs, which deletes their pages as they are read. */
+  void StartMerge();
+
+  /**
+   * Reads the next page of a run into its cursor.
+   * @return false if the run has no more pages
+   */
+  auto ReadPage(size_t run) -> bool;
+
+  /** @return the next pair of the merge with a new key, false if all runs are read */
+  auto MergeNext(MappingType *pair) -> bool;
+
+  /** @return true if the pair at the cursor of run a comes after the pair at the cursor of run b */
+  auto RunAfter(size_t a, size_t b) const -> bool;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t run_size_;
+  /** The extent owner the pages of the runs are allocated for, released by the destructor. */
+  owner_id_t owner_id_{BufferPoolManager::NewOwnerId()};
+  /** Pairs in memory: the run that is being filled, or all pairs if no run was written. */
+  std::vector<MappingType> buffer_;
+  /** Position of the next pair in buffer_ once sorted, if no run was written. */
+  size_t buffer_position_{0};
+  std::vector<Run> runs_;
+  std::vector<Cursor> cursors_;
+  /** Runs that still have pairs to merge, as a heap on their next pair. */
+  std::vector<size_t> heap_;
+  bool is_merging_{false};
+  bool has_last_key_{false};
+  KeyType last_key_;
+  size_t num_pairs_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
 #include "storage/table/tuple.h"
@@ -94,6 +95,23 @@ class GenericComparator {
     return 0;
   }
 
+  /**
+   * A key that is cut short, with its last bytes zeroed, must keep the bytes that locate its variable length columns:
+   * their offsets, and the lengths stored at those offsets. Otherwise its columns are read from outside of the key.
+   * @return the number of leading bytes of key that a shortened copy of it must keep
+   */
+  inline size_t MinTruncatedLength(const GenericKey<KeySize> &key) const {
+    size_t length = 0;
+    for (const auto &column : key_schema_->GetColumns()) {
+      if (!column.IsInlined()) {
+        int32_t offset = *reinterpret_cast<const int32_t *>(key.data_ + column.GetOffset());
+        length = std::max<size_t>(length, column.GetOffset() + sizeof(int32_t));
+        length = std::max<size_t>(length, offset + sizeof(uint32_t));
+      }
+    }
+    return std::min(length, KeySize);
+  }
+
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
 
   // constructor
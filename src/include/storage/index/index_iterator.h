@@ -38,6 +38,10 @@ class IndexIterator {
 
   auto operator==(const IndexIterator &itr) const -> bool {
     // throw std::runtime_error("unimplemented");
+    if (node_ == nullptr || itr.node_ == nullptr) {
+      // iterators of an empty tree
+      return node_ == itr.node_;
+    }
     return node_->GetPageId() == itr.node_->GetPageId() && index_ == itr.index_;
   }
 
@@ -48,11 +52,13 @@ class IndexIterator {
 
  private:
   // add your own private member variables here
-  BufferPoolManager *buffer_pool_manager_;
-  Page *page_;
-  int index_;
-  LeafPage *node_;
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  int index_{0};
+  LeafPage *node_{nullptr};
   bool is_nullptr_{true};
+  // the pair last read, which a compressed leaf page does not hold as is
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -13,6 +13,7 @@
 #include <queue>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_key_array.h"
 
 namespace bustub {
 
@@ -31,12 +32,17 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * A compressed internal page holds its pairs in a CompressedKeyArray after the
+ * header. Its keys are mostly separators that were cut short when a leaf split,
+ * so it holds many more children than a plain page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool is_compressed = false);
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
@@ -51,6 +57,15 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Remove(int index);
   auto RemoveAndReturnOnlyChild() -> ValueType;
 
+  // size checks, by number of children or by bytes in a compressed page
+  auto IsSafeToInsert() const -> bool;
+  auto IsFull() const -> bool;
+  auto IsSafeToRemove() const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto CanSetKeyAt(int index, const KeyType &key) const -> bool;
+  auto CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const -> bool;
+  auto GetFillRatio() const -> double;
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
@@ -60,6 +75,11 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
+  using KeyArray = CompressedKeyArray<KeyType, ValueType>;
+
+  auto Entries() -> KeyArray * { return reinterpret_cast<KeyArray *>(array_); }
+  auto Entries() const -> const KeyArray * { return reinterpret_cast<const KeyArray *>(array_); }
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
   void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_key_array.h"
 
 namespace bustub {
 
@@ -38,19 +39,32 @@ namespace bustub {
  *  -----------------------------------------------
  * | ParentPageId (4) | PageId (4) | NextPageId (4)
  *  -----------------------------------------------
+ *
+ * A compressed leaf page holds its pairs in a CompressedKeyArray after the
+ * header. It splits when it has less room left than the largest pair takes,
+ * and underflows when less than half of its bytes are used.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool is_compressed = false);
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
-  auto GetItem(int index) -> const MappingType &;
+  auto GetItem(int index) -> MappingType;
+
+  // size checks, by number of pairs or by bytes in a compressed page
+  auto IsSafeToInsert() const -> bool;
+  auto IsFull() const -> bool;
+  auto IsSafeToRemove() const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto CanMoveAllTo(const BPlusTreeLeafPage *recipient) const -> bool;
+  auto GetFillRatio() const -> double;
 
   // insert and delete methods
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
@@ -64,6 +78,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
+  using KeyArray = CompressedKeyArray<KeyType, ValueType>;
+
+  auto Entries() -> KeyArray * { return reinterpret_cast<KeyArray *>(array_); }
+  auto Entries() const -> const KeyArray * { return reinterpret_cast<const KeyArray *>(array_); }
   void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
@@ -24,8 +24,15 @@ namespace bustub {
 
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
-// define page type enum
-enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+// define page type enum. A compressed page stores its entries in a CompressedKeyArray instead of an array of pairs,
+// behind the same header. It is full when its bytes are used up, and ignores MaxSize.
+enum class IndexPageType {
+  INVALID_INDEX_PAGE = 0,
+  LEAF_PAGE,
+  INTERNAL_PAGE,
+  COMPRESSED_LEAF_PAGE,
+  COMPRESSED_INTERNAL_PAGE
+};
 
 /**
  * Both internal and leaf page are inherited from this page.
@@ -62,6 +69,8 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  auto IsCompressed() const -> bool;
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
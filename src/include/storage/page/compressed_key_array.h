@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_key_array.h
+//
+// Identification: src/include/storage/page/compressed_key_array.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define COMPRESSED_KEY_ARRAY_TYPE CompressedKeyArray<KeyType, ValueType>
+
+/**
+ * CompressedKeyArray holds the sorted (key, value) pairs of a B+ tree page in the compressed page format. It is laid
+ * over the bytes of the page that follow the page header, in place of the array of pairs.
+ *
+ * Keys are fixed size, but are mostly made of bytes that many keys share, or of the zero bytes that pad them. So the
+ * page stores one prefix, and every entry stores only the number of leading bytes it shares with that prefix and the
+ * bytes that follow them, without the trailing zero bytes. Keys are rebuilt in full when they are read, so a page in
+ * this format returns the same keys as one in the plain format.
+ *
+ * Entries are variable length, and a page is full when its bytes are used up, not at a number of entries.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------------------
+ * | Size (2) | HeapStart (2) | PrefixLength (2) | Prefix (sizeof(KeyType)) | Slot(1) | Slot(2) | ... | Slot(n) |
+ *  ------------------------------------------------------------------------------
+ *  ------------------------------------------------
+ * | ... free space ... | Entry(x) | ... | Entry(y) |
+ *  ------------------------------------------------
+ * Slots hold the offsets of the entries, in key order. Entries are packed at the end, in any order:
+ *  -------------------------------------------------------------------------
+ * | SharedLength (1) | SuffixLength (1) | Suffix (SuffixLength) | ValueType |
+ *  -------------------------------------------------------------------------
+ *
+ * The number of entries is kept in the page header, and is passed in by the page.
+ */
+template <typename KeyType, typename ValueType>
+class CompressedKeyArray {
+  static_assert(sizeof(KeyType) <= UINT8_MAX, "key lengths must fit in one byte");
+
+ public:
+  /** Bytes in front of the slots. */
+  static constexpr size_t HEADER_SIZE = 3 * sizeof(uint16_t) + sizeof(KeyType);
+
+  /** Bytes that the largest entry uses, its slot included. */
+  static constexpr size_t MAX_ENTRY_SIZE = sizeof(uint16_t) + 2 + sizeof(KeyType) + sizeof(ValueType);
+
+  /**
+   * Initializes an empty array.
+   * @param size bytes of the array, its header included
+   */
+  void Init(size_t size);
+
+  /** @return bytes of the array that hold slots and entries */
+  auto GetDataSize() const -> size_t { return size_ - HEADER_SIZE; }
+
+  /** @return bytes that the slots and entries use */
+  auto GetUsedSize(int num_entries) const -> size_t { return size_ - heap_start_ + num_entries * sizeof(uint16_t); }
+
+  /** @return bytes that are left for new entries */
+  auto GetFreeSize(int num_entries) const -> size_t { return GetDataSize() - GetUsedSize(num_entries); }
+
+  /** @return bytes that the entry at index uses, its slot included */
+  auto GetEntrySize(int index) const -> size_t;
+
+  /** @return bytes that an entry for key would use with the current prefix, its slot included */
+  auto GetEntrySize(const KeyType &key) const -> size_t;
+
+  auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+
+  /** @return all entries, in order */
+  auto GetItems(int num_entries) const -> std::vector<MappingType>;
+
+  /**
+   * Inserts an entry in front of the one at index. There must be room for it. The first entry of an empty array
+   * becomes its prefix.
+   */
+  void Insert(int num_entries, int index, const KeyType &key, const ValueType &value);
+
+  /** Removes the entry at index and packs the others. */
+  void Remove(int num_entries, int index);
+
+  /** Replaces the key at index. There must be room for the new key. */
+  void SetKeyAt(int num_entries, int index, const KeyType &key);
+
+  /**
+   * Replaces all entries, with the prefix that stores them in the fewest bytes.
+   * @param items the new entries, in order
+   * @param other the array the entries come from, whose prefix is tried as well, nullptr if none
+   */
+  void Assign(const std::vector<MappingType> &items, const CompressedKeyArray *other);
+
+  /** @return bytes that Assign would use for the same entries */
+  auto GetAssignedSize(const std::vector<MappingType> &items, const CompressedKeyArray *other) const -> size_t;
+
+  /** @return the length of key without its trailing zero bytes */
+  static auto KeyLength(const KeyType &key) -> size_t;
+
+ private:
+  /** @return the length of the common prefix of two byte strings */
+  static auto CommonPrefixLength(const char *a, size_t a_length, const char *b, size_t b_length) -> size_t;
+
+  /** @return the prefix that stores items in the fewest bytes, and that number of bytes */
+  auto ChoosePrefix(const std::vector<MappingType> &items, const CompressedKeyArray *other) const
+      -> std::pair<std::vector<char>, size_t>;
+
+  /** Writes an entry in front of the others. @return its offset */
+  auto AppendEntry(const KeyType &key, const ValueType &value) -> uint16_t;
+
+  auto Data() -> char * { return reinterpret_cast<char *>(this); }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this); }
+  auto Slots() -> uint16_t * { return reinterpret_cast<uint16_t *>(Data() + HEADER_SIZE); }
+  auto Slots() const -> const uint16_t * { return reinterpret_cast<const uint16_t *>(Data() + HEADER_SIZE); }
+
+  uint16_t size_;
+  /** Offset of the first byte of the entries. */
+  uint16_t heap_start_;
+  uint16_t prefix_length_;
+  char prefix_[sizeof(KeyType)];
+};
+
+}  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +27,24 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The page data lives outside the Page object, in the frame arena of the buffer pool. Every Page starts on its own
+ * cache line, so the book-keeping of neighbouring frames is never falsely shared.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates page data of its own and zeros it out. */
+  Page() : owned_data_(new char[PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
+
+  /**
+   * Constructor for a page whose data is owned by someone else, e.g. a frame of the buffer pool.
+   * @param data PAGE_SIZE bytes of page data
+   */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,7 +56,7 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -78,14 +91,16 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** Storage for the page data if the page is not backed by a buffer pool frame. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  char *data_;
+  /** The ID of this page. Atomic because the buffer pool pins resident pages without its latch. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. Negative while the frame is free or reserved by the buffer pool. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -28,7 +28,8 @@ class TableHeap {
   friend class TableIterator;
 
  public:
-  ~TableHeap() = default;
+  /** Retires the owner id of the heap, so that disk managers give up the extent of its pages. */
+  ~TableHeap();
 
   /**
    * Create a table heap without a transaction. (open table)
@@ -95,12 +96,17 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param access_type how the page of the tuple is fetched
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type = AccessType::Normal);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn transaction performing the scan
+   * @param access_type how the pages are fetched, a sequential scan by default so that it does not flood the pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, AccessType access_type = AccessType::SequentialScan);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -108,11 +114,19 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the extent owner the pages of this table are allocated for */
+  inline owner_id_t GetOwnerId() const { return owner_id_; }
+
+  /** @return the buffer pool that holds the pages of this table */
+  inline BufferPoolManager *GetBufferPoolManager() const { return buffer_pool_manager_; }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  // the extent owner new pages of the table are allocated for
+  owner_id_t owner_id_{BufferPoolManager::NewOwnerId()};
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_pool_manager.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +30,14 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                AccessType access_type = AccessType::SequentialScan);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        access_type_(other.access_type_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,6 +57,7 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    access_type_ = other.access_type_;
     return *this;
   }
 
@@ -59,6 +65,8 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** How the pages of the table are fetched while iterating. */
+  AccessType access_type_;
 };
 
 }  // namespace bustub
@@ -10,10 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
 #include <cstring>
 #include <iostream>
+#include <new>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -23,14 +31,23 @@
 
 namespace bustub {
 
+static_assert(DiskManager::EXTENT_SIZE == 64, "an extent is one word of the free-space map");
+
 static char *buffer_used;
 
+// owners retired with RetireOwner, in order, for every disk manager to release
+static std::mutex retired_owners_latch;
+static std::vector<owner_id_t> retired_owners;
+// the size of retired_owners, so that allocations need not take retired_owners_latch when nothing was retired
+static std::atomic<size_t> num_retired_owners{0};
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager() = default;
+
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -52,73 +69,317 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
+  // create the file if it does not exist
+  direct_io_ = direct_io && OpenDirect(db_file);
+  if (direct_io && !direct_io_) {
+    LOG_INFO("%s does not support O_DIRECT, using buffered I/O", db_file.c_str());
+  }
+  if (!direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ == -1) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = NumPagesIn(static_cast<uint64_t>(stat_buf.st_size)) * PAGE_SIZE;
+  }
+  LoadFreeSpaceMap();
+  buffer_used = nullptr;
+}
+
+void DiskManager::LoadFreeSpaceMap() {
+  struct stat stat_buf;
+  uint64_t file_size = fstat(db_fd_, &stat_buf) == 0 ? static_cast<uint64_t>(stat_buf.st_size) : 0;
+  if (file_size == 0) {
+    return;
+  }
+
+  // Every page of the file comes after the page of the map that tracks it.
+  auto file_pages = static_cast<page_id_t>(db_file_size_ / PAGE_SIZE);
+  size_t num_fsm_pages = (file_size / PAGE_SIZE + FSM_PAGE_BITS) / (FSM_PAGE_BITS + 1);
+  ResizeFsm(num_fsm_pages * FSM_PAGE_BITS);
+  for (size_t fsm_page = 0; fsm_page < num_fsm_pages; ++fsm_page) {
+    auto *data = reinterpret_cast<char *>(fsm_.data() + fsm_page * (PAGE_SIZE / 8));
+    if (!ReadFully(data, PAGE_SIZE, FsmPageOffset(fsm_page))) {
+      throw Exception("can't read free-space map");
+    }
+  }
+
+  // The file may end in deallocated pages, which stay free.
+  next_page_id_ = file_pages;
+  for (size_t word = fsm_.size(); word > 0; --word) {
+    if (fsm_[word - 1] != 0) {
+      auto highest = static_cast<page_id_t>((word - 1) * 64 + 63 - __builtin_clzll(fsm_[word - 1]));
+      next_page_id_ = std::max(next_page_id_, highest + 1);
+      break;
+    }
+  }
+  fsm_search_start_ = 0;
+}
+
+bool DiskManager::OpenDirect(const std::string &db_file) {
+#ifdef O_DIRECT
+  // File systems without direct I/O refuse the flag with EINVAL. Any other error is not about the flag.
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+  if (db_fd_ == -1) {
+    if (errno != EINVAL) {
       throw Exception("can't open db file");
     }
+    return false;
+  }
+  // Some file systems accept the flag and fail the I/O instead.
+  AlignedBuffer probe = AllocateAligned(PAGE_SIZE);
+  ssize_t read_count;
+  do {
+    read_count = pread(db_fd_, probe.get(), PAGE_SIZE, 0);
+  } while (read_count < 0 && errno == EINTR);
+  if (read_count >= 0) {
+    return true;
+  }
+  int read_errno = errno;
+  close(db_fd_);
+  db_fd_ = -1;
+  if (read_errno != EINVAL) {
+    throw Exception("can't read db file");
+  }
+#endif
+  return false;
+}
+
+DiskManager::AlignedBuffer DiskManager::AllocateAligned(size_t size) {
+  void *data = nullptr;
+  if (posix_memalign(&data, PAGE_SIZE, std::max<size_t>(size, PAGE_SIZE)) != 0) {
+    throw std::bad_alloc();
+  }
+  return AlignedBuffer(static_cast<char *>(data));
+}
+
+const char *DiskManager::MapDbFile(size_t *size) {
+  uint64_t num_pages = db_file_size_ / PAGE_SIZE;
+  if (num_pages == 0) {
+    *size = 0;
+    return nullptr;
+  }
+  *size = PageOffset(static_cast<page_id_t>(num_pages - 1)) + PAGE_SIZE;
+  void *data = mmap(nullptr, *size, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (data == MAP_FAILED) {
+    LOG_DEBUG("can't map db file");
+    *size = 0;
+    return nullptr;
+  }
+  return static_cast<const char *>(data);
+}
+
+void DiskManager::UnmapDbFile(const char *data, size_t size) {
+  if (data != nullptr) {
+    munmap(const_cast<char *>(data), size);
   }
-  buffer_used = nullptr;
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
   log_io_.close();
+  if (db_fd_ != -1) {
+    FlushFreeSpaceMap();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  SyncAllocation(page_id);
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  if (!WriteFully(page_data, PAGE_SIZE, PageOffset(page_id))) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  ExtendDbFileSize(static_cast<uint64_t>(page_id + 1) * PAGE_SIZE);
+}
+
+/**
+ * Write the contents of many pages into disk file, coalescing neighbouring pages, and sync the file once
+ */
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  // The free-space map is synced together with the pages, so that the pages written are allocated after a restart.
+  // New pages need it synced before them.
+  for (const auto &page : pages) {
+    SyncAllocation(page.first);
+  }
+  FlushFreeSpaceMap();
+  if (pages.empty()) {
+    return;
+  }
+
+  std::sort(pages.begin(), pages.end());
+
+  // Direct I/O cannot write from unaligned pages, so write aligned copies of them.
+  size_t num_unaligned =
+      std::count_if(pages.begin(), pages.end(), [&](const auto &page) { return NeedsBounce(page.second); });
+  AlignedBuffer copies;
+  if (num_unaligned > 0) {
+    copies = AllocateAligned(num_unaligned * PAGE_SIZE);
+    char *copy = copies.get();
+    for (auto &page : pages) {
+      if (NeedsBounce(page.second)) {
+        memcpy(copy, page.second, PAGE_SIZE);
+        page.second = copy;
+        copy += PAGE_SIZE;
+      }
+    }
+  }
+
+  std::vector<iovec> iov;
+  size_t begin = 0;
+  while (begin < pages.size()) {
+    // one run: consecutive page ids that no page of the free-space map separates, at most IOV_MAX of them
+    iov.clear();
+    size_t end = begin;
+    while (end < pages.size() && iov.size() < IOV_MAX &&
+           pages[end].first == pages[begin].first + static_cast<page_id_t>(end - begin) &&
+           (end == begin || pages[end].first % FSM_PAGE_BITS != 0)) {
+      iov.push_back({const_cast<char *>(pages[end].second), PAGE_SIZE});
+      ++end;
+    }
+
+    // the run is contiguous in the file, so the cached size grows by what was written of it
+    auto run_offset = static_cast<off_t>(PageOffset(pages[begin].first));
+    auto run_size = static_cast<uint64_t>(pages[begin].first) * PAGE_SIZE;
+    off_t offset = run_offset;
+    size_t first_iov = 0;
+    while (first_iov < iov.size()) {
+      ssize_t written = pwritev(db_fd_, iov.data() + first_iov, static_cast<int>(iov.size() - first_iov), offset);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      num_writes_ += 1;
+      offset += written;
+      ExtendDbFileSize(run_size + (offset - run_offset));
+      // skip what was written, which may end in the middle of a page
+      while (written > 0) {
+        auto length = static_cast<ssize_t>(iov[first_iov].iov_len);
+        if (written < length) {
+          iov[first_iov].iov_base = static_cast<char *>(iov[first_iov].iov_base) + written;
+          iov[first_iov].iov_len -= written;
+          break;
+        }
+        written -= length;
+        ++first_iov;
+      }
+    }
+    begin = end;
+  }
+
+#ifdef __APPLE__
+  fsync(db_fd_);
+#else
+  fdatasync(db_fd_);
+#endif
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  num_reads_ += 1;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (static_cast<uint64_t>(page_id) * PAGE_SIZE >= db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  if (!ReadFully(page_data, PAGE_SIZE, PageOffset(page_id))) {
+    LOG_DEBUG("I/O error while reading");
+  }
+}
+
+/**
+ * Read the contents of consecutive pages into the given memory area with one read
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) {
+  num_reads_ += 1;
+  // A page of the free-space map splits the read in two.
+  while (num_pages > 0) {
+    size_t run = std::min<size_t>(num_pages, FSM_PAGE_BITS - first_page_id % FSM_PAGE_BITS);
+    if (!ReadFully(page_data, run * PAGE_SIZE, PageOffset(first_page_id))) {
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    first_page_id += static_cast<page_id_t>(run);
+    num_pages -= run;
+    page_data += run * PAGE_SIZE;
+  }
+}
+
+bool DiskManager::WriteFully(const char *data, size_t size, uint64_t offset) {
+  if (NeedsBounce(data)) {
+    AlignedBuffer bounce = AllocateAligned(PAGE_SIZE);
+    for (size_t done = 0; done < size; done += PAGE_SIZE) {
+      memcpy(bounce.get(), data + done, PAGE_SIZE);
+      if (!WriteFully(bounce.get(), PAGE_SIZE, offset + done)) {
+        return false;
+      }
     }
+    return true;
+  }
+  while (size > 0) {
+    ssize_t written = pwrite(db_fd_, data, size, static_cast<off_t>(offset));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+bool DiskManager::ReadFully(char *data, size_t size, uint64_t offset) {
+  if (NeedsBounce(data)) {
+    AlignedBuffer bounce = AllocateAligned(PAGE_SIZE);
+    for (size_t done = 0; done < size; done += PAGE_SIZE) {
+      if (!ReadFully(bounce.get(), PAGE_SIZE, offset + done)) {
+        return false;
+      }
+      memcpy(data + done, bounce.get(), PAGE_SIZE);
+    }
+    return true;
+  }
+  while (size > 0) {
+    ssize_t read_count = pread(db_fd_, data, size, static_cast<off_t>(offset));
+    if (read_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (read_count == 0) {
+      // the file ends within the range
+      memset(data, 0, size);
+      break;
+    }
+    data += read_count;
+    size -= read_count;
+    offset += read_count;
+  }
+  return true;
+}
+
+void DiskManager::ExtendDbFileSize(uint64_t end) {
+  uint64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
   }
 }
 
@@ -186,16 +447,198 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse a free page from the free-space map, or grow the file
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t hint, owner_id_t owner) {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  if (num_released_retired_owners_ != num_retired_owners) {
+    ReleaseRetiredOwners();
+  }
+  page_id_t page_id;
+  if (owner != INVALID_OWNER_ID) {
+    auto extent = owner_extents_.find(owner);
+    if (extent == owner_extents_.end()) {
+      extent = owner_extents_.emplace(owner, ReserveExtent(SIZE_MAX)).first;
+    } else if (~fsm_[extent->second] == 0) {
+      // The extent is full, so nothing is left to keep for the owner.
+      reserved_extents_[extent->second] = false;
+      extent->second = ReserveExtent(extent->second + 1);
+    }
+    page_id = static_cast<page_id_t>(extent->second * EXTENT_SIZE + __builtin_ctzll(~fsm_[extent->second]));
+  } else {
+    page_id = FindFreePage(hint);
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = next_page_id_++;
+      ResizeFsm(next_page_id_);
+    }
+  }
+  fsm_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+  dirty_fsm_pages_.insert(page_id / FSM_PAGE_BITS);
+  if (db_fd_ != -1) {
+    unsynced_allocations_.insert(page_id);
+    num_unsynced_allocations_ = unsynced_allocations_.size();
+  }
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Clear its bit in the free-space map, so that it is reused
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || !TestFsmBit(page_id)) {
+    return;
+  }
+  fsm_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  unsynced_allocations_.erase(page_id);
+  num_unsynced_allocations_ = unsynced_allocations_.size();
+  fsm_search_start_ = std::min(fsm_search_start_, page_id);
+  extent_search_start_ = std::min(extent_search_start_, static_cast<size_t>(page_id / EXTENT_SIZE));
+  dirty_fsm_pages_.insert(page_id / FSM_PAGE_BITS);
+}
+
+void DiskManager::ReleaseOwner(owner_id_t owner) {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  ReleaseExtentOf(owner);
+}
+
+void DiskManager::RetireOwner(owner_id_t owner) {
+  std::lock_guard<std::mutex> guard(retired_owners_latch);
+  retired_owners.push_back(owner);
+  num_retired_owners = retired_owners.size();
+}
+
+void DiskManager::ReleaseRetiredOwners() {
+  std::lock_guard<std::mutex> guard(retired_owners_latch);
+  for (; num_released_retired_owners_ < retired_owners.size(); num_released_retired_owners_++) {
+    ReleaseExtentOf(retired_owners[num_released_retired_owners_]);
+  }
+}
+
+void DiskManager::ReleaseExtentOf(owner_id_t owner) {
+  auto extent = owner_extents_.find(owner);
+  if (extent == owner_extents_.end()) {
+    return;
+  }
+  // The free pages of the extent can be taken by anyone now.
+  reserved_extents_[extent->second] = false;
+  fsm_search_start_ = std::min(fsm_search_start_, static_cast<page_id_t>(extent->second * EXTENT_SIZE));
+  extent_search_start_ = std::min(extent_search_start_, extent->second);
+  owner_extents_.erase(extent);
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  return page_id >= 0 && page_id < next_page_id_ && TestFsmBit(page_id);
+}
+
+size_t DiskManager::GetNumFreePages() {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  size_t num_allocated = 0;
+  for (auto word : fsm_) {
+    num_allocated += __builtin_popcountll(word);
+  }
+  return static_cast<size_t>(next_page_id_) - num_allocated;
+}
+
+page_id_t DiskManager::FindFreePage(page_id_t hint) {
+  if (hint >= 0 && hint < next_page_id_) {
+    // Pages after the hint first, so that pages used together are read in order.
+    for (page_id_t distance = 1; distance <= FSM_HINT_DISTANCE; ++distance) {
+      if (hint + distance < next_page_id_ && !IsTaken(hint + distance)) {
+        return hint + distance;
+      }
+      if (hint - distance >= fsm_search_start_ && !IsTaken(hint - distance)) {
+        return hint - distance;
+      }
+    }
+  }
+
+  // All pages below fsm_search_start_ are taken, so only the words from there on are searched.
+  for (auto word = static_cast<size_t>(fsm_search_start_) / 64; word * 64 < static_cast<size_t>(next_page_id_);
+       ++word) {
+    if (~fsm_[word] != 0 && !reserved_extents_[word]) {
+      auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(~fsm_[word]));
+      if (page_id >= next_page_id_) {
+        break;
+      }
+      fsm_search_start_ = page_id;
+      return page_id;
+    }
+  }
+  fsm_search_start_ = next_page_id_;
+  return INVALID_PAGE_ID;
+}
+
+size_t DiskManager::ReserveExtent(size_t preferred_extent) {
+  // Only extents below the end of the file can be free, as the file grows by whole extents for owners.
+  size_t num_extents = next_page_id_ / EXTENT_SIZE;
+  auto is_free = [&](size_t extent) {
+    return extent < num_extents && fsm_[extent] == 0 && !reserved_extents_[extent];
+  };
+
+  size_t extent = preferred_extent;
+  if (!is_free(extent)) {
+    extent = extent_search_start_;
+    while (extent < num_extents && !is_free(extent)) {
+      ++extent;
+    }
+    extent_search_start_ = extent;
+    if (extent == num_extents) {
+      // Pages between the end of the file and the next extent boundary stay free for allocations without an owner.
+      extent = (next_page_id_ + EXTENT_SIZE - 1) / EXTENT_SIZE;
+      next_page_id_ = static_cast<page_id_t>((extent + 1) * EXTENT_SIZE);
+      ResizeFsm(next_page_id_);
+    }
+  }
+  reserved_extents_[extent] = true;
+  return extent;
+}
+
+void DiskManager::ResizeFsm(size_t num_pages) {
+  size_t num_words = (num_pages + FSM_PAGE_BITS - 1) / FSM_PAGE_BITS * (PAGE_SIZE / 8);
+  if (fsm_.size() < num_words) {
+    fsm_.resize(num_words, 0);
+    reserved_extents_.resize(num_words, false);
+  }
+}
+
+void DiskManager::FlushFreeSpaceMap() {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  WriteFsmPages();
+}
+
+void DiskManager::WriteFsmPages() {
+  if (db_fd_ != -1) {
+    for (auto fsm_page : dirty_fsm_pages_) {
+      const auto *data = reinterpret_cast<const char *>(fsm_.data() + fsm_page * (PAGE_SIZE / 8));
+      if (!WriteFully(data, PAGE_SIZE, FsmPageOffset(fsm_page))) {
+        LOG_DEBUG("I/O error while writing free-space map");
+      }
+    }
+  }
+  dirty_fsm_pages_.clear();
+}
+
+void DiskManager::SyncAllocation(page_id_t page_id) {
+  if (num_unsynced_allocations_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  if (unsynced_allocations_.count(page_id) == 0) {
+    return;
+  }
+  // All allocations so far become durable at once, so the next new pages are written without a sync.
+  WriteFsmPages();
+#ifdef __APPLE__
+  fsync(db_fd_);
+#else
+  fdatasync(db_fd_);
+#endif
+  unsynced_allocations_.clear();
+  num_unsynced_allocations_ = 0;
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,6 +650,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.cpp
+//
+// Identification: src/storage/disk/disk_manager_memory.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+char *DiskManagerMemory::GetPage(page_id_t page_id) const {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= pages_.size()) {
+    return nullptr;
+  }
+  return pages_[page_id].get();
+}
+
+void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  StorePage(page_id, page_data);
+}
+
+void DiskManagerMemory::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    StorePage(pages[i].first, pages[i].second);
+    // Count a write per run of consecutive pages, as the file-backed disk manager does.
+    if (i == 0 || pages[i].first != pages[i - 1].first + 1) {
+      num_writes_ += 1;
+    }
+  }
+}
+
+void DiskManagerMemory::StorePage(page_id_t page_id, const char *page_data) {
+  {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    // Writers of one page are serialized by the buffer pool, so the copy needs no exclusive latch.
+    char *page = GetPage(page_id);
+    if (page != nullptr) {
+      memcpy(page, page_data, PAGE_SIZE);
+      return;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  if (static_cast<size_t>(page_id) >= pages_.size()) {
+    pages_.resize(page_id + 1);
+  }
+  if (pages_[page_id] == nullptr) {
+    pages_[page_id].reset(new char[PAGE_SIZE]);
+  }
+  memcpy(pages_[page_id].get(), page_data, PAGE_SIZE);
+  ExtendDbFileSize(static_cast<uint64_t>(page_id + 1) * PAGE_SIZE);
+}
+
+void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  const char *page = GetPage(page_id);
+  if (page == nullptr) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, page, PAGE_SIZE);
+}
+
+void DiskManagerMemory::ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) {
+  num_reads_ += 1;
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  for (size_t i = 0; i < num_pages; ++i) {
+    const char *page = GetPage(first_page_id + static_cast<page_id_t>(i));
+    if (page == nullptr) {
+      memset(page_data + i * PAGE_SIZE, 0, PAGE_SIZE);
+    } else {
+      memcpy(page_data + i * PAGE_SIZE, page, PAGE_SIZE);
+    }
+  }
+}
+
+void DiskManagerMemory::WriteLog(char *log_data, int size) {
+  if (size == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(log_latch_);
+  num_flushes_ += 1;
+  log_.insert(log_.end(), log_data, log_data + size);
+}
+
+bool DiskManagerMemory::ReadLog(char *log_data, int size, int offset) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+    return false;
+  }
+  size_t read_count = std::min(static_cast<size_t>(size), log_.size() - offset);
+  memcpy(log_data, log_.data() + offset, read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+const char *DiskManagerMemory::MapDbFile(size_t *size) {
+  *size = 0;
+  return nullptr;
+}
+
+}  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_slow.cpp
+//
+// Identification: src/storage/disk/disk_manager_slow.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_slow.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+void DiskManagerSlow::Delay(std::chrono::microseconds latency, size_t num_bytes) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = start + latency;
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (options_.queue_depth_ > 0) {
+      queue_cv_.wait(lock, [&] { return num_in_flight_ < options_.queue_depth_; });
+      start = std::chrono::steady_clock::now();
+      done = start + latency;
+    }
+    ++num_in_flight_;
+    if (options_.bandwidth_ > 0 && num_bytes > 0) {
+      // The transfer follows the latency and the transfers the device was given earlier.
+      auto transfer = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(static_cast<double>(num_bytes) / options_.bandwidth_));
+      transfer_end_ = std::max(transfer_end_, done) + transfer;
+      done = transfer_end_;
+    }
+  }
+  std::this_thread::sleep_until(done);
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    --num_in_flight_;
+  }
+  queue_cv_.notify_one();
+}
+
+void DiskManagerSlow::WritePage(page_id_t page_id, const char *page_data) {
+  Delay(options_.write_latency_, PAGE_SIZE);
+  disk_manager_->WritePage(page_id, page_data);
+}
+
+void DiskManagerSlow::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  // One write per run of consecutive pages, as the file-backed disk manager issues them, then one sync.
+  std::sort(pages.begin(), pages.end());
+  size_t begin = 0;
+  while (begin < pages.size()) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first == pages[end - 1].first + 1) {
+      ++end;
+    }
+    Delay(options_.write_latency_, (end - begin) * PAGE_SIZE);
+    begin = end;
+  }
+  Delay(options_.sync_latency_, 0);
+  disk_manager_->WritePages(std::move(pages));
+}
+
+void DiskManagerSlow::ReadPage(page_id_t page_id, char *page_data) {
+  Delay(options_.read_latency_, PAGE_SIZE);
+  disk_manager_->ReadPage(page_id, page_data);
+}
+
+void DiskManagerSlow::ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) {
+  Delay(options_.read_latency_, num_pages * PAGE_SIZE);
+  disk_manager_->ReadPages(first_page_id, num_pages, page_data);
+}
+
+void DiskManagerSlow::WriteLog(char *log_data, int size) {
+  if (size > 0) {
+    Delay(options_.write_latency_, size);
+    Delay(options_.sync_latency_, 0);
+  }
+  disk_manager_->WriteLog(log_data, size);
+}
+
+bool DiskManagerSlow::ReadLog(char *log_data, int size, int offset) {
+  Delay(options_.read_latency_, size);
+  return disk_manager_->ReadLog(log_data, size, offset);
+}
+
+}  // namespace bustub
@@ -0,0 +1,333 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/**
+ * A minimal io_uring on top of the raw system calls: one submission ring, one completion ring and the array of
+ * submission queue entries, all shared with the kernel.
+ */
+struct DiskScheduler::IoUring {
+  ~IoUring() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != nullptr) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (fd_ != -1) {
+      close(fd_);
+    }
+  }
+
+  /** @return a ring with room for entries submissions, nullptr if the kernel refuses to set one up */
+  static std::unique_ptr<IoUring> Create(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    auto ring = std::make_unique<IoUring>();
+    ring->fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring->fd_ < 0) {
+      ring->fd_ = -1;
+      return nullptr;
+    }
+    ring->entries_ = params.sq_entries;
+
+    ring->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      ring->sq_size_ = ring->cq_size_ = std::max(ring->sq_size_, ring->cq_size_);
+    }
+    ring->sq_ptr_ = ring->Map(ring->sq_size_, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr_ == nullptr) {
+      return nullptr;
+    }
+    ring->cq_ptr_ = single_mmap ? ring->sq_ptr_ : ring->Map(ring->cq_size_, IORING_OFF_CQ_RING);
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes_ = static_cast<io_uring_sqe *>(ring->Map(ring->sqes_size_, IORING_OFF_SQES));
+    if (ring->cq_ptr_ == nullptr || ring->sqes_ == nullptr) {
+      return nullptr;
+    }
+
+    auto *sq = static_cast<char *>(ring->sq_ptr_);
+    ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    ring->sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(ring->cq_ptr_);
+    ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    ring->cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return ring;
+  }
+
+  /** Adds a vectored read or write to the submission ring. The caller never has more than entries_ in flight. */
+  void Prepare(bool is_write, int fd, const iovec *iov, uint64_t offset, void *user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uint64_t>(user_data);
+    sq_array_[index] = index;
+    // The kernel may read the entry as soon as it sees the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * Submits prepared entries and optionally waits for completions.
+   * @return the number of entries the kernel took, or -errno
+   */
+  int Enter(unsigned to_submit, unsigned min_complete) {
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int result = static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0));
+    return result < 0 ? -errno : result;
+  }
+
+  /** Takes the next completion off the completion ring. @return false if there is none */
+  bool PopCompletion(void **user_data, int *result) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    io_uring_cqe *cqe = &cqes_[head & cq_mask_];
+    *user_data = reinterpret_cast<void *>(cqe->user_data);
+    *result = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /** @return the mapping of a region of the ring, nullptr on failure */
+  void *Map(size_t size, off_t offset) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  int fd_{-1};
+  /** Number of submission queue entries. */
+  unsigned entries_{0};
+  void *sq_ptr_{nullptr};
+  size_t sq_size_{0};
+  void *cq_ptr_{nullptr};
+  size_t cq_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#else
+
+struct DiskScheduler::IoUring {};
+
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, bool use_io_uring, size_t num_workers)
+    : disk_manager_(disk_manager) {
+#ifdef BUSTUB_HAVE_IO_URING
+  // Only a file-backed disk manager has a descriptor to submit I/O on.
+  if (use_io_uring && disk_manager->db_fd_ != -1) {
+    ring_ = IoUring::Create(DISK_SCHEDULER_QUEUE_DEPTH);
+  }
+#endif
+  if (ring_ != nullptr) {
+    threads_.emplace_back(&DiskScheduler::RunIoUring, this);
+    return;
+  }
+  for (size_t i = 0; i < std::max<size_t>(1, num_workers); ++i) {
+    threads_.emplace_back(&DiskScheduler::RunWorker, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    queue_.push_back(std::move(request));
+  }
+  queue_cv_.notify_one();
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> requests) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &request : requests) {
+      queue_.push_back(std::move(request));
+    }
+  }
+  queue_cv_.notify_all();
+}
+
+bool DiskScheduler::ReadPage(page_id_t page_id, char *page_data) {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule(DiskRequest{false, page_data, page_id, std::move(promise)});
+  return future.get();
+}
+
+bool DiskScheduler::WritePage(page_id_t page_id, const char *page_data) {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule(DiskRequest{true, const_cast<char *>(page_data), page_id, std::move(promise)});
+  return future.get();
+}
+
+void DiskScheduler::RunWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    queue_cv_.wait(lock, [&] { return !queue_.empty() || stop_; });
+    if (queue_.empty()) {
+      return;
+    }
+    DiskRequest request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    RunRequest(&request);
+    lock.lock();
+  }
+}
+
+void DiskScheduler::RunRequest(DiskRequest *request) {
+  if (request->is_write_) {
+    disk_manager_->WritePage(request->page_id_, request->data_);
+  } else {
+    disk_manager_->ReadPage(request->page_id_, request->data_);
+  }
+  request->callback_.set_value(true);
+}
+
+void DiskScheduler::RunIoUring() {
+#ifdef BUSTUB_HAVE_IO_URING
+  // A request the kernel is working on, with the iovec it points to.
+  struct InFlight {
+    DiskRequest request_;
+    iovec iov_;
+  };
+
+  size_t num_in_flight = 0;
+  // Entries in the submission ring that the kernel has not taken yet.
+  unsigned num_unsubmitted = 0;
+  std::vector<DiskRequest> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      if (num_in_flight == 0) {
+        queue_cv_.wait(lock, [&] { return !queue_.empty() || stop_; });
+        if (queue_.empty()) {
+          return;
+        }
+      }
+      while (!queue_.empty() && num_in_flight + batch.size() < ring_->entries_) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+
+    for (auto &request : batch) {
+      uint64_t offset = DiskManager::PageOffset(request.page_id_);
+      // A page past the end of the file reads as zeros without asking the kernel. Direct I/O on an unaligned buffer
+      // needs the copy the blocking calls make.
+      if ((!request.is_write_ && static_cast<uint64_t>(request.page_id_) * PAGE_SIZE >= disk_manager_->db_file_size_) ||
+          disk_manager_->NeedsBounce(request.data_)) {
+        RunRequest(&request);
+        continue;
+      }
+      // As with WritePage, a new page is only written once the free-space map that allocates it is on disk.
+      if (request.is_write_) {
+        disk_manager_->SyncAllocation(request.page_id_);
+      }
+      auto *op = new InFlight{std::move(request), {}};
+      op->iov_ = {op->request_.data_, PAGE_SIZE};
+      ring_->Prepare(op->request_.is_write_, disk_manager_->db_fd_, &op->iov_, offset, op);
+      ++num_in_flight;
+      ++num_unsubmitted;
+    }
+    batch.clear();
+
+    // Submit what is new without waiting. With nothing new to submit, wait for the next completion instead.
+    if (num_unsubmitted > 0 || num_in_flight > 0) {
+      int result = ring_->Enter(num_unsubmitted, num_unsubmitted == 0 ? 1 : 0);
+      if (result > 0) {
+        num_unsubmitted -= std::min<unsigned>(num_unsubmitted, result);
+      }
+    }
+
+    void *user_data;
+    int result;
+    while (ring_->PopCompletion(&user_data, &result)) {
+      auto *op = static_cast<InFlight *>(user_data);
+      DiskRequest &request = op->request_;
+      if (result == PAGE_SIZE) {
+        if (request.is_write_) {
+          ++disk_manager_->num_writes_;
+          disk_manager_->ExtendDbFileSize(static_cast<uint64_t>(request.page_id_ + 1) * PAGE_SIZE);
+        } else {
+          ++disk_manager_->num_reads_;
+        }
+        request.callback_.set_value(true);
+      } else if (!request.is_write_ && result >= 0) {
+        // The file ends within the page.
+        ++disk_manager_->num_reads_;
+        memset(request.data_ + result, 0, PAGE_SIZE - result);
+        request.callback_.set_value(true);
+      } else {
+        // Errors, interrupted requests and short writes are retried with the blocking calls.
+        RunRequest(&request);
+      }
+      delete op;
+      --num_in_flight;
+    }
+  }
+#endif
+}
+
+}  // namespace bustub
@@ -9,24 +9,33 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
 #include <string>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
+#include "storage/disk/disk_manager.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool compress_keys)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      compress_keys_(compress_keys) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() { DiskManager::RetireOwner(owner_id_); }
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -43,13 +52,10 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  rwlatch_.RLock();
-  if (IsEmpty()) {
-    rwlatch_.RUnlock();
+  Page *leaf_page = FindLeafPage(key);
+  if (leaf_page == nullptr) {
     return false;
   }
-
-  Page *leaf_page = FindLeafPage(key);
   auto *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
   ValueType value;
@@ -78,14 +84,36 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  rwlatch_.WLock();
-  if (IsEmpty()) {
-    StartNewTree(key, value);
-    rwlatch_.WUnlock();
+  while (IsEmpty()) {
+    std::lock_guard<std::mutex> guard(new_tree_latch_);
+    if (IsEmpty()) {
+      StartNewTree(key, value);
+      return true;
+    }
+  }
 
-    return true;
+  // Optimistic pass: most inserts do not split the leaf, so only the leaf is write latched.
+  Page *page = FindLeafPageToWrite(key);
+  if (page == nullptr) {
+    // The last key was removed since the tree was checked.
+    return Insert(key, value, transaction);
   }
+  auto *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
 
+  ValueType old_value;
+  bool is_duplicate = leaf_node->Lookup(key, &old_value, comparator_);
+  bool is_safe = leaf_node->IsSafeToInsert();
+  if (is_safe && !is_duplicate) {
+    leaf_node->Insert(key, value, comparator_);
+  }
+
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe && !is_duplicate);
+  if (is_safe || is_duplicate) {
+    return !is_duplicate;
+  }
+
+  // Pessimistic pass: the leaf would split, latch the path from the root.
   return InsertIntoLeaf(key, value, transaction);
 }
 /*
@@ -97,13 +125,13 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageNear(&page_id, INVALID_PAGE_ID, owner_id_);
   if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
 
   auto root_node = reinterpret_cast<LeafPage *>(page->GetData());
-  root_node->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root_node->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, compress_keys_);
   root_node->Insert(key, value, comparator_);
 
   root_page_id_ = page_id;
@@ -115,7 +143,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewRoot(BPlusTreePage *left_node, const KeyType &key, BPlusTreePage *right_node) {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageNear(&page_id, INVALID_PAGE_ID, owner_id_);
   if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
@@ -124,7 +152,7 @@ void BPLUSTREE_TYPE::StartNewRoot(BPlusTreePage *left_node, const KeyType &key,
   right_node->SetParentPageId(page_id);
 
   auto root_node = reinterpret_cast<InternalPage *>(page->GetData());
-  root_node->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+  root_node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, compress_keys_);
   root_node->PopulateNewRoot(left_node->GetPageId(), key, right_node->GetPageId());
   root_page_id_ = page_id;
   UpdateRootPageId(0);
@@ -141,17 +169,16 @@ void BPLUSTREE_TYPE::StartNewRoot(BPlusTreePage *left_node, const KeyType &key,
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  bool is_root_latched = true;
-
-  page_id_t page_id = root_page_id_;
-  Page *page = buffer_pool_manager_->FetchPage(page_id);
-  page->WLatch();
+  Page *page = FetchRootPage(RootLatchMode::WRITE);
+  if (page == nullptr) {
+    return Insert(key, value, transaction);
+  }
 
   auto *curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   while (!curr_node->IsLeafPage()) {
     auto *node = reinterpret_cast<InternalPage *>(page->GetData());
-    page_id = node->Lookup(key, comparator_);
+    page_id_t page_id = node->Lookup(key, comparator_);
 
     transaction->AddIntoPageSet(page);
 
@@ -160,12 +187,7 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
     curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
-    if (curr_node->GetSize() + 1 < curr_node->GetMaxSize()) {
-      if (is_root_latched) {
-        is_root_latched = false;
-        rwlatch_.WUnlock();
-      }
-
+    if (IsSafeToInsert(curr_node)) {
       for (Page *pg : *transaction->GetPageSet()) {
         pg->WUnlatch();
         buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -178,11 +200,6 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
   int size = leaf_node->GetSize();
   if (leaf_node->Insert(key, value, comparator_) == size) {
-    if (is_root_latched) {
-      is_root_latched = false;
-      rwlatch_.WUnlock();
-    }
-
     for (Page *pg : *transaction->GetPageSet()) {
       pg->WUnlatch();
       buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -195,24 +212,20 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     return false;
   }
 
-  if (leaf_node->GetSize() == leaf_node->GetMaxSize()) {
+  if (leaf_node->IsFull()) {
     LeafPage *left_node = leaf_node;
     LeafPage *right_node = SplitLeafNode(left_node);
+    KeyType separator = Separator(left_node->KeyAt(left_node->GetSize() - 1), right_node->KeyAt(0));
 
     if (left_node->IsRootPage()) {
-      StartNewRoot(left_node, right_node->KeyAt(0), right_node);
+      StartNewRoot(left_node, separator, right_node);
     } else {
-      InsertIntoParent(left_node, right_node->KeyAt(0), right_node, transaction);
+      InsertIntoParent(left_node, separator, right_node, transaction);
     }
 
     buffer_pool_manager_->UnpinPage(right_node->GetPageId(), true);
   }
 
-  if (is_root_latched) {
-    is_root_latched = false;
-    rwlatch_.WUnlock();
-  }
-
   for (Page *pg : *transaction->GetPageSet()) {
     pg->WUnlatch();
     buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -240,13 +253,13 @@ auto BPLUSTREE_TYPE::Split(N *node) -> N * {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::SplitLeafNode(LeafPage *left_node) -> LeafPage * {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageNear(&page_id, left_node->GetPageId(), owner_id_);
   if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
 
   auto *right_node = reinterpret_cast<LeafPage *>(page->GetData());
-  right_node->Init(page_id, left_node->GetParentPageId(), left_node->GetMaxSize());
+  right_node->Init(page_id, left_node->GetParentPageId(), left_node->GetMaxSize(), compress_keys_);
   left_node->MoveHalfTo(right_node);
   right_node->SetNextPageId(left_node->GetNextPageId());
   left_node->SetNextPageId(right_node->GetPageId());
@@ -257,13 +270,14 @@ auto BPLUSTREE_TYPE::SplitLeafNode(LeafPage *left_node) -> LeafPage * {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::SplitInternalNode(InternalPage *left_node) -> InternalPage * {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageNear(&page_id, left_node->GetPageId(), owner_id_);
   if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
 
   auto *right_node = reinterpret_cast<InternalPage *>(page->GetData());
-  right_node->Init(page_id, left_node->GetParentPageId(), left_node->GetMaxSize());
+  // Init adds the slot an internal page overflows into, which GetMaxSize already counts.
+  right_node->Init(page_id, left_node->GetParentPageId(), internal_max_size_, compress_keys_);
   left_node->MoveHalfTo(right_node, buffer_pool_manager_);
 
   return right_node;
@@ -288,7 +302,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   auto internal_node = reinterpret_cast<InternalPage *>(page->GetData());
   internal_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
 
-  if (internal_node->GetSize() == internal_node->GetMaxSize()) {
+  if (internal_node->IsFull()) {
     InternalPage *left_node = internal_node;
     InternalPage *right_node = SplitInternalNode(left_node);
 
@@ -305,6 +319,155 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Build the tree from the sorted pairs of an external sorter, instead of
+ * inserting them one by one: leaves are filled from left to right, and every
+ * internal level above them as its children are created, so each page is
+ * written once. Nodes are filled up to fill_factor, by entries or by bytes if
+ * keys are compressed, and levels are added on top as the tree grows. Only
+ * the nodes on the right edge can end up below their min size, and they get
+ * entries from their left neighbors once all pairs are in.
+ * @return: false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(EXTERNAL_SORTER_TYPE *sorter, double fill_factor) -> bool {
+  std::lock_guard<std::mutex> guard(new_tree_latch_);
+  if (!IsEmpty()) {
+    return false;
+  }
+  MappingType pair;
+  if (!sorter->Next(&pair)) {
+    return true;
+  }
+
+  std::vector<BulkLoadLevel> levels{NewBulkLoadLevel(true, fill_factor)};
+  KeyType last_key;
+  do {
+    auto *leaf_node = reinterpret_cast<LeafPage *>(BulkLoadNode(&levels, 0, pair.first)->GetData());
+    leaf_node->Insert(pair.first, pair.second, comparator_);
+    last_key = pair.first;
+  } while (sorter->Next(&pair));
+
+  // Readers that find the new root wait at the right edge until it is filled up. The nodes left of it are latched
+  // by the rebalancing of Remove as they lend entries.
+  std::vector<page_id_t> page_ids;
+  for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+    level->page_->WLatch();
+    page_ids.push_back(level->page_->GetPageId());
+  }
+  root_page_id_ = page_ids.front();
+  UpdateRootPageId(1);
+
+  // Top down, so that the parent of each node has enough children that one of them is a left neighbor. The last key
+  // leads to the node on the right edge at every level.
+  Transaction transaction(INVALID_TXN_ID);
+  auto is_deleted = [&transaction](Page *page) {
+    return transaction.GetDeletedPageSet()->count(page->GetPageId()) != 0;
+  };
+  for (size_t level = levels.size() - 1; level-- > 0;) {
+    Page *page = levels[level].page_;
+    // A compressed neighbor may have no entry to lend, in which case the node stays as it is.
+    if (level == 0) {
+      auto *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
+      for (int size = -1; leaf_node->IsUnderflow() && !is_deleted(page) && leaf_node->GetSize() != size;) {
+        size = leaf_node->GetSize();
+        AdjustLeafNode(leaf_node, last_key, &transaction);
+      }
+    } else {
+      auto *internal_node = reinterpret_cast<InternalPage *>(page->GetData());
+      for (int size = -1; internal_node->IsUnderflow() && !is_deleted(page) && internal_node->GetSize() != size;) {
+        size = internal_node->GetSize();
+        AdjustInternalNode(internal_node, last_key, &transaction);
+      }
+    }
+  }
+
+  for (auto &level : levels) {
+    level.page_->WUnlatch();
+    buffer_pool_manager_->UnpinPage(level.page_->GetPageId(), true);
+  }
+  DeletePages(page_ids.front(), &transaction);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewBulkLoadLevel(bool is_leaf, double fill_factor) const -> BulkLoadLevel {
+  if (compress_keys_) {
+    // The bytes that entries take are only known as they come, so nodes are filled by bytes instead.
+    return {INT_MAX, nullptr, std::clamp(fill_factor, 0.5, 1.0)};
+  }
+  // Leaves split once they are full, internal pages once they have one child more than their max size.
+  int capacity = is_leaf ? leaf_max_size_ - 1 : internal_max_size_;
+  int min_size = std::max(is_leaf ? leaf_max_size_ / 2 : (internal_max_size_ + 1) / 2, 1);
+  return {std::clamp(static_cast<int>(fill_factor * capacity), min_size, capacity), nullptr, fill_factor};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadNode(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &first_key)
+    -> Page * {
+  Page *last_page = (*levels)[level].page_;
+  if (last_page != nullptr) {
+    auto *last_node = reinterpret_cast<BPlusTreePage *>(last_page->GetData());
+    if (last_node->GetSize() < (*levels)[level].node_size_ && IsSafeToInsert(last_node) &&
+        (!compress_keys_ || GetFillRatio(last_node) < (*levels)[level].fill_factor_)) {
+      return last_page;
+    }
+  }
+
+  page_id_t page_id;
+  page_id_t hint = last_page == nullptr ? INVALID_PAGE_ID : last_page->GetPageId();
+  Page *page = buffer_pool_manager_->NewPageNear(&page_id, hint, owner_id_);
+  if (page == nullptr) {
+    throw std::runtime_error("out of memory");
+  }
+
+  // The separator between two leaves is cut short, and kept by the levels above.
+  KeyType separator = first_key;
+  if (level == 0 && last_page != nullptr) {
+    auto *last_leaf = reinterpret_cast<LeafPage *>(last_page->GetData());
+    separator = Separator(last_leaf->KeyAt(last_leaf->GetSize() - 1), first_key);
+  }
+
+  // A top level that outgrows its only node gets a new root above, whose first child is that node.
+  if (level + 1 == levels->size() && last_page != nullptr) {
+    levels->push_back(NewBulkLoadLevel(false, (*levels)[level].fill_factor_));
+    Page *root_page = BulkLoadNode(levels, level + 1, separator);
+    reinterpret_cast<InternalPage *>(root_page->GetData())
+        ->InsertNodeAfter(INVALID_PAGE_ID, separator, last_page->GetPageId());
+    reinterpret_cast<BPlusTreePage *>(last_page->GetData())->SetParentPageId(root_page->GetPageId());
+  }
+
+  // The new node is the next child of the open node of the level above.
+  page_id_t parent_page_id = INVALID_PAGE_ID;
+  if (level + 1 < levels->size()) {
+    Page *parent_page = BulkLoadNode(levels, level + 1, separator);
+    auto *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    int size = parent_node->GetSize();
+    parent_node->InsertNodeAfter(size == 0 ? INVALID_PAGE_ID : parent_node->ValueAt(size - 1), separator, page_id);
+    parent_page_id = parent_page->GetPageId();
+  }
+
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, parent_page_id, leaf_max_size_, compress_keys_);
+    if (last_page != nullptr) {
+      reinterpret_cast<LeafPage *>(last_page->GetData())->SetNextPageId(page_id);
+    }
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())
+        ->Init(page_id, parent_page_id, internal_max_size_, compress_keys_);
+  }
+  if (last_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  }
+
+  // Levels above may have been added, so the level is looked up again.
+  (*levels)[level].page_ = page;
+  return page;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -317,23 +480,38 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  rwlatch_.WLock();
-  bool is_root_latched = true;
+  // Optimistic pass: most removes do not underflow the leaf, so only the leaf is write latched.
+  Page *leaf_page = FindLeafPageToWrite(key);
+  if (leaf_page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
-  if (IsEmpty()) {
-    rwlatch_.WUnlock();
+  ValueType old_value;
+  bool is_found = leaf->Lookup(key, &old_value, comparator_);
+  bool is_safe = leaf->IsRootPage() ? leaf->GetSize() > 1 : leaf->IsSafeToRemove();
+  if (is_safe && is_found) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+  }
+
+  leaf_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), is_safe && is_found);
+  if (is_safe || !is_found) {
     return;
   }
 
-  page_id_t page_id = root_page_id_;
-  Page *page = buffer_pool_manager_->FetchPage(page_id);
-  page->WLatch();
+  // Pessimistic pass: the leaf would underflow, latch the path from the root.
+  Page *page = FetchRootPage(RootLatchMode::WRITE);
+  if (page == nullptr) {
+    return;
+  }
+  page_id_t root_page_id = page->GetPageId();
 
   auto *curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   while (!curr_node->IsLeafPage()) {
     auto *node = reinterpret_cast<InternalPage *>(page->GetData());
-    page_id = node->Lookup(key, comparator_);
+    page_id_t page_id = node->Lookup(key, comparator_);
 
     transaction->AddIntoPageSet(page);
 
@@ -342,12 +520,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 
     curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
-    if (curr_node->GetSize() > curr_node->GetMinSize()) {
-      if (is_root_latched) {
-        is_root_latched = false;
-        rwlatch_.WUnlock();
-      }
-
+    if (IsSafeToRemove(curr_node)) {
       for (Page *pg : *transaction->GetPageSet()) {
         pg->WUnlatch();
         buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -360,11 +533,6 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 
   int size = leaf_node->GetSize();
   if (leaf_node->RemoveAndDeleteRecord(key, comparator_) == size) {
-    if (is_root_latched) {
-      is_root_latched = false;
-      rwlatch_.WUnlock();
-    }
-
     for (Page *pg : *transaction->GetPageSet()) {
       pg->WUnlatch();
       buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -377,15 +545,10 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     return;
   }
 
-  if (leaf_node->GetSize() < leaf_node->GetMinSize()) {
+  if (leaf_node->IsUnderflow()) {
     AdjustLeafNode(leaf_node, key, transaction);
   }
 
-  if (is_root_latched) {
-    is_root_latched = false;
-    rwlatch_.WUnlock();
-  }
-
   for (Page *pg : *transaction->GetPageSet()) {
     pg->WUnlatch();
     buffer_pool_manager_->UnpinPage(pg->GetPageId(), false);
@@ -395,11 +558,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 
-  for (auto page_id : *transaction->GetDeletedPageSet()) {
-    buffer_pool_manager_->DeletePage(page_id);
-    // std::this_thread::sleep_for(std::chrono::milliseconds(5));
-  }
-  transaction->GetDeletedPageSet()->clear();
+  DeletePages(root_page_id, transaction);
 }
 
 /*
@@ -437,10 +596,15 @@ void BPLUSTREE_TYPE::AdjustLeafNode(LeafPage *leaf_node, const KeyType &key, Tra
     left_neigh_page->WLatch();
     auto left_neigh_node = reinterpret_cast<LeafPage *>(left_neigh_page->GetData());
 
-    if (left_neigh_node->GetSize() > left_neigh_node->GetMinSize()) {
+    // A compressed page may lack the room for the new separator, or for the pairs of both leaves.
+    int size = left_neigh_node->GetSize();
+    bool can_lend = left_neigh_node->IsSafeToRemove();
+    KeyType separator =
+        can_lend ? Separator(left_neigh_node->KeyAt(size - 2), left_neigh_node->KeyAt(size - 1)) : KeyType();
+    if (can_lend && parent_node->CanSetKeyAt(index, separator)) {
       left_neigh_node->MoveLastToFrontOf(leaf_node);
-      parent_node->SetKeyAt(index, leaf_node->KeyAt(0));
-    } else {
+      parent_node->SetKeyAt(index, separator);
+    } else if (leaf_node->CanMoveAllTo(left_neigh_node)) {
       leaf_node->MoveAllTo(left_neigh_node);
       left_neigh_node->SetNextPageId(leaf_node->GetNextPageId());
       parent_node->Remove(index);
@@ -455,10 +619,12 @@ void BPLUSTREE_TYPE::AdjustLeafNode(LeafPage *leaf_node, const KeyType &key, Tra
     right_neigh_page->WLatch();
     auto right_neigh_node = reinterpret_cast<LeafPage *>(right_neigh_page->GetData());
 
-    if (right_neigh_node->GetSize() > right_neigh_node->GetMinSize()) {
+    bool can_lend = right_neigh_node->IsSafeToRemove();
+    KeyType separator = can_lend ? Separator(right_neigh_node->KeyAt(0), right_neigh_node->KeyAt(1)) : KeyType();
+    if (can_lend && parent_node->CanSetKeyAt(index + 1, separator)) {
       right_neigh_node->MoveFirstToEndOf(leaf_node);
-      parent_node->SetKeyAt(index + 1, right_neigh_node->KeyAt(0));
-    } else {
+      parent_node->SetKeyAt(index + 1, separator);
+    } else if (right_neigh_node->CanMoveAllTo(leaf_node)) {
       right_neigh_node->MoveAllTo(leaf_node);
       leaf_node->SetNextPageId(right_neigh_node->GetNextPageId());
       parent_node->Remove(index + 1);
@@ -469,7 +635,7 @@ void BPLUSTREE_TYPE::AdjustLeafNode(LeafPage *leaf_node, const KeyType &key, Tra
     buffer_pool_manager_->UnpinPage(right_neigh_page->GetPageId(), true);
   }
 
-  if (parent_node->GetSize() < parent_node->GetMinSize()) {
+  if (parent_node->IsUnderflow()) {
     AdjustInternalNode(parent_node, key, transaction);
   }
 
@@ -504,10 +670,11 @@ void BPLUSTREE_TYPE::AdjustInternalNode(InternalPage *internal_node, const KeyTy
     left_neigh_page->WLatch();
     auto left_neigh_node = reinterpret_cast<InternalPage *>(left_neigh_page->GetData());
 
-    if (left_neigh_node->GetSize() > left_neigh_node->GetMinSize()) {
+    KeyType separator = left_neigh_node->KeyAt(left_neigh_node->GetSize() - 1);
+    if (left_neigh_node->IsSafeToRemove() && parent_node->CanSetKeyAt(index, separator)) {
       left_neigh_node->MoveLastToFrontOf(internal_node, parent_node->KeyAt(index), buffer_pool_manager_);
       parent_node->SetKeyAt(index, internal_node->KeyAt(0));
-    } else {
+    } else if (internal_node->CanMoveAllTo(left_neigh_node, parent_node->KeyAt(index))) {
       internal_node->MoveAllTo(left_neigh_node, parent_node->KeyAt(index), buffer_pool_manager_);
       parent_node->Remove(index);
       transaction->AddIntoDeletedPageSet(internal_node->GetPageId());
@@ -521,10 +688,10 @@ void BPLUSTREE_TYPE::AdjustInternalNode(InternalPage *internal_node, const KeyTy
     right_neigh_page->WLatch();
     auto right_neigh_node = reinterpret_cast<InternalPage *>(right_neigh_page->GetData());
 
-    if (right_neigh_node->GetSize() > right_neigh_node->GetMinSize()) {
+    if (right_neigh_node->IsSafeToRemove() && parent_node->CanSetKeyAt(index + 1, right_neigh_node->KeyAt(1))) {
       right_neigh_node->MoveFirstToEndOf(internal_node, parent_node->KeyAt(index + 1), buffer_pool_manager_);
       parent_node->SetKeyAt(index + 1, right_neigh_node->KeyAt(0));
-    } else {
+    } else if (right_neigh_node->CanMoveAllTo(internal_node, parent_node->KeyAt(index + 1))) {
       right_neigh_node->MoveAllTo(internal_node, parent_node->KeyAt(index + 1), buffer_pool_manager_);
       parent_node->Remove(index + 1);
       transaction->AddIntoDeletedPageSet(right_neigh_node->GetPageId());
@@ -534,7 +701,7 @@ void BPLUSTREE_TYPE::AdjustInternalNode(InternalPage *internal_node, const KeyTy
     buffer_pool_manager_->UnpinPage(right_neigh_page->GetPageId(), true);
   }
 
-  if (parent_node->GetSize() < parent_node->GetMinSize()) {
+  if (parent_node->IsUnderflow()) {
     AdjustInternalNode(parent_node, key, transaction);
   }
 
@@ -596,8 +763,10 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return f
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  rwlatch_.RLock();
   Page *page = FindLeafPage(KeyType(), 1);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
   return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
 }
 
@@ -608,8 +777,10 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  rwlatch_.RLock();
   Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
   int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
   return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
 }
@@ -621,8 +792,10 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
-  rwlatch_.RLock();
   Page *page = FindLeafPage(KeyType(), 2);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
   int index = reinterpret_cast<LeafPage *>(page->GetData())->GetSize();
   return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
 }
@@ -630,22 +803,99 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
+/*
+ * Fetch and latch the root page of the tree.
+ * The root page id is read without a latch, so it is read again once the page
+ * is latched: a writer only changes it while holding the latch of the root
+ * page, so if it is unchanged, the latched page is the root until it is
+ * unlatched. Otherwise the root changed in between and the fetch is retried.
+ * The id read may be that of an old root that was deleted meanwhile. Its page
+ * is then read in, found not to be the root and dropped. While it is pinned,
+ * the buffer pool does not hand out its id again, so a page latched under the
+ * current root id is the root.
+ * With WRITE_LEAF, the root page is write latched if it is a leaf, and read
+ * latched otherwise.
+ * @return : the latched root page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchRootPage(RootLatchMode mode) -> Page * {
+  while (true) {
+    page_id_t page_id = root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      // Only worth retrying for a different root.
+      if (root_page_id_ == page_id) {
+        throw std::runtime_error("out of memory");
+      }
+      continue;
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    // Only a guess until the page is latched, checked below.
+    bool is_write = mode == RootLatchMode::WRITE || (mode == RootLatchMode::WRITE_LEAF && node->IsLeafPage());
+    if (is_write) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+
+    if (root_page_id_ == page_id && (mode != RootLatchMode::WRITE_LEAF || node->IsLeafPage() == is_write)) {
+      return page;
+    }
+
+    if (is_write) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+}
+
+/*
+ * Delete the pages in the deleted page set of the transaction. An old root
+ * can still be pinned by a FetchRootPage that read its id before the root
+ * changed, in which case it is kept for a later call.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(page_id_t old_root_page_id, Transaction *transaction) {
+  std::lock_guard<std::mutex> guard(old_roots_latch_);
+  for (auto page_id : *transaction->GetDeletedPageSet()) {
+    if (page_id == old_root_page_id) {
+      old_root_page_ids_.push_back(page_id);
+    } else {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    // std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  transaction->GetDeletedPageSet()->clear();
+
+  auto end = std::remove_if(old_root_page_ids_.begin(), old_root_page_ids_.end(),
+                            [&](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  old_root_page_ids_.erase(end, old_root_page_ids_.end());
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * @return : the read latched leaf page, nullptr if the tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, int option) -> Page * {
   // throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
-  page_id_t page_id = root_page_id_;
-  Page *page = buffer_pool_manager_->FetchPage(page_id);
-  page->RLatch();
-  rwlatch_.RUnlock();
+  Page *page = FetchRootPage(RootLatchMode::READ);
+  if (page == nullptr) {
+    return nullptr;
+  }
 
   auto *curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   while (!curr_node->IsLeafPage()) {
     auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    page_id_t page_id = INVALID_PAGE_ID;
     if (option == 0) {
       page_id = node->Lookup(key, comparator_);
     } else if (option == 1) {
@@ -667,6 +917,92 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, int option) -> Page * {
   return page;
 }
 
+/*
+ * Find the leaf page that a key is inserted into or removed from, and write
+ * latch it. Internal pages are read latched on the way down, each released
+ * once its child is latched, so writers that stay within one leaf only block
+ * each other on that leaf.
+ * @return : the write latched leaf page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageToWrite(const KeyType &key) -> Page * {
+  Page *page = FetchRootPage(RootLatchMode::WRITE_LEAF);
+  if (page == nullptr) {
+    return nullptr;
+  }
+
+  auto *curr_node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  // Whether a page is a leaf never changes while a latched parent points to it.
+  while (!curr_node->IsLeafPage()) {
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    Page *child_page = buffer_pool_manager_->FetchPage(node->Lookup(key, comparator_));
+    curr_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (curr_node->IsLeafPage()) {
+      child_page->WLatch();
+    } else {
+      child_page->RLatch();
+    }
+
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+
+  return page;
+}
+
+/*
+ * Check whether a node stays without split when one entry is inserted below
+ * it, or without underflow when one is removed below it, so that the latches
+ * of its ancestors can be released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafeToInsert(BPlusTreePage *node) const -> bool {
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<LeafPage *>(node)->IsSafeToInsert();
+  }
+  return reinterpret_cast<InternalPage *>(node)->IsSafeToInsert();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafeToRemove(BPlusTreePage *node) const -> bool {
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<LeafPage *>(node)->IsSafeToRemove();
+  }
+  return reinterpret_cast<InternalPage *>(node)->IsSafeToRemove();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetFillRatio(BPlusTreePage *node) const -> double {
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<LeafPage *>(node)->GetFillRatio();
+  }
+  return reinterpret_cast<InternalPage *>(node)->GetFillRatio();
+}
+
+/*
+ * Return the key that separates the last key of a leaf from the first key of
+ * its right neighbor in their parent. With compressed keys, it is the shortest
+ * prefix of right_key, with the rest zeroed, that sorts after left_key and not
+ * after right_key, so parents hold many more children. The prefix keeps the
+ * bytes the comparator needs to read the key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Separator(const KeyType &left_key, const KeyType &right_key) -> KeyType {
+  if (!compress_keys_) {
+    return right_key;
+  }
+  size_t length = CompressedKeyArray<KeyType, ValueType>::KeyLength(right_key);
+  for (size_t prefix_length = comparator_.MinTruncatedLength(right_key); prefix_length < length; ++prefix_length) {
+    KeyType separator{};
+    memcpy(reinterpret_cast<char *>(&separator), reinterpret_cast<const char *>(&right_key), prefix_length);
+    if (comparator_(left_key, separator) < 0 && comparator_(separator, right_key) <= 0) {
+      return separator;
+    }
+  }
+  return right_key;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -678,6 +1014,9 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, int option) -> Page * {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  // Each root change holds the latch of the old root only, so two of them can get here at once. With the header page
+  // latched, the one that comes last writes the latest root page id.
+  header_page->WLatch();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -685,6 +1024,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
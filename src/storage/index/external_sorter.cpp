@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sorter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::ExternalSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                     size_t run_size)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), run_size_(std::max<size_t>(run_size, 1)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::~ExternalSorter() {
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    // Pages before the cursor of the merge are gone already.
+    size_t first_page = is_merging_ ? cursors_[i].next_page_ : 0;
+    for (size_t page = first_page; page < runs_[i].page_ids_.size(); ++page) {
+      buffer_pool_manager_->DeletePage(runs_[i].page_ids_[page]);
+    }
+  }
+  buffer_pool_manager_->ReleaseOwner(owner_id_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == run_size_) {
+    WriteRun();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Sort() {
+  if (runs_.empty()) {
+    SortBuffer();
+    return;
+  }
+
+  if (!buffer_.empty()) {
+    WriteRun();
+  }
+  std::vector<MappingType>().swap(buffer_);
+  StartMerge();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::Next(MappingType *pair) -> bool {
+  if (!runs_.empty()) {
+    if (!MergeNext(pair)) {
+      return false;
+    }
+  } else if (buffer_position_ < buffer_.size()) {
+    *pair = buffer_[buffer_position_++];
+  } else {
+    return false;
+  }
+  ++num_pairs_;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SortBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+  auto end = std::unique(buffer_.begin(), buffer_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) == 0;
+  });
+  buffer_.erase(end, buffer_.end());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::WriteRun() {
+  SortBuffer();
+
+  Run run;
+  run.num_pairs_ = buffer_.size();
+  page_id_t page_id = INVALID_PAGE_ID;
+  for (size_t offset = 0; offset < buffer_.size(); offset += PAIRS_PER_PAGE) {
+    // Pages of a run are read in order, so they are placed next to each other.
+    Page *page = buffer_pool_manager_->NewPageNear(&page_id, page_id, owner_id_);
+    if (page == nullptr) {
+      throw std::runtime_error("out of memory");
+    }
+    size_t num_pairs = std::min(PAIRS_PER_PAGE, buffer_.size() - offset);
+    memcpy(page->GetData(), &buffer_[offset], num_pairs * sizeof(MappingType));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    run.page_ids_.push_back(page_id);
+  }
+
+  runs_.push_back(std::move(run));
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::StartMerge() {
+  is_merging_ = true;
+  cursors_.assign(runs_.size(), Cursor{0, 0, {}, 0});
+  heap_.clear();
+  for (size_t run = 0; run < runs_.size(); ++run) {
+    cursors_[run].num_unread_ = runs_[run].num_pairs_;
+    if (ReadPage(run)) {
+      heap_.push_back(run);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return RunAfter(a, b); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::ReadPage(size_t run) -> bool {
+  Cursor &cursor = cursors_[run];
+  if (cursor.next_page_ == runs_[run].page_ids_.size()) {
+    return false;
+  }
+
+  page_id_t page_id = runs_[run].page_ids_[cursor.next_page_];
+  Page *page = buffer_pool_manager_->FetchPage(page_id, AccessType::SequentialScan);
+  if (page == nullptr) {
+    throw std::runtime_error("out of memory");
+  }
+  size_t num_pairs = std::min(PAIRS_PER_PAGE, cursor.num_unread_);
+  auto *pairs = reinterpret_cast<const MappingType *>(page->GetData());
+  cursor.pairs_.assign(pairs, pairs + num_pairs);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+
+  ++cursor.next_page_;
+  cursor.num_unread_ -= num_pairs;
+  cursor.position_ = 0;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::MergeNext(MappingType *pair) -> bool {
+  auto run_after = [this](size_t a, size_t b) { return RunAfter(a, b); };
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), run_after);
+    size_t run = heap_.back();
+    Cursor &cursor = cursors_[run];
+    MappingType next = cursor.pairs_[cursor.position_++];
+    if (cursor.position_ < cursor.pairs_.size() || ReadPage(run)) {
+      std::push_heap(heap_.begin(), heap_.end(), run_after);
+    } else {
+      heap_.pop_back();
+    }
+
+    // Equal keys come out of the runs in the order they were added, so the first one is kept.
+    if (has_last_key_ && comparator_(next.first, last_key_) == 0) {
+      continue;
+    }
+    has_last_key_ = true;
+    last_key_ = next.first;
+    *pair = next;
+    return true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::RunAfter(size_t a, size_t b) const -> bool {
+  const Cursor &cursor_a = cursors_[a];
+  const Cursor &cursor_b = cursors_[b];
+  int result = comparator_(cursor_a.pairs_[cursor_a.position_].first, cursor_b.pairs_[cursor_b.position_].first);
+  if (result != 0) {
+    return result > 0;
+  }
+  // Earlier runs hold the pairs that were added first.
+  return a > b;
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -18,6 +18,7 @@ INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *
       index_(index),
       node_(reinterpret_cast<LeafPage *>(page_->GetData())) {
   is_nullptr_ = false;
+  buffer_pool_manager_->PrefetchPage(node_->GetNextPageId());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -31,13 +32,18 @@ INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
   // throw std::runtime_error("unimplemented");
+  if (node_ == nullptr) {
+    // iterator of an empty tree
+    return true;
+  }
   return node_->GetNextPageId() == INVALID_PAGE_ID && index_ >= node_->GetSize();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
   // throw std::runtime_error("unimplemented");
-  return node_->GetItem(index_);
+  item_ = node_->GetItem(index_);
+  return item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -55,6 +61,8 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
 
     node_ = reinterpret_cast<LeafPage *>(page_->GetData());
     index_ = 0;
+    // Start reading the next leaf while this one is scanned.
+    buffer_pool_manager_->PrefetchPage(node_->GetNextPageId());
   }
 
   return *this;
@@ -25,26 +25,119 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  SetPageType(IndexPageType::INTERNAL_PAGE);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool is_compressed) {
+  SetPageType(is_compressed ? IndexPageType::COMPRESSED_INTERNAL_PAGE : IndexPageType::INTERNAL_PAGE);
   SetSize(0);
   SetMaxSize(max_size + 1);
   SetParentPageId(parent_id);
   SetPageId(page_id);
+  if (is_compressed) {
+    Entries()->Init(PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE);
+  }
+}
+
+/*
+ * Helper methods to check the size of the page before and after a change.
+ * A plain page counts children against its max/min size, a compressed page
+ * counts bytes as a compressed leaf page does.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToInsert() const -> bool {
+  if (IsCompressed()) {
+    return Entries()->GetFreeSize(GetSize()) >= 2 * KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() + 1 < GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsFull() const -> bool {
+  if (IsCompressed()) {
+    return Entries()->GetFreeSize(GetSize()) < KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() == GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToRemove() const -> bool {
+  if (IsCompressed()) {
+    return 2 * Entries()->GetUsedSize(GetSize()) >= Entries()->GetDataSize() + 2 * KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() > GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const -> bool {
+  if (IsCompressed()) {
+    return 2 * Entries()->GetUsedSize(GetSize()) < Entries()->GetDataSize();
+  }
+  return GetSize() < GetMinSize();
+}
+
+/*
+ * Check that the key at index can be replaced without filling the page. In a
+ * compressed page the new key may take more bytes than the old one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const -> bool {
+  if (!IsCompressed()) {
+    return true;
+  }
+  return Entries()->GetUsedSize(GetSize()) - Entries()->GetEntrySize(index) + Entries()->GetEntrySize(key) +
+             KeyArray::MAX_ENTRY_SIZE <=
+         Entries()->GetDataSize();
+}
+
+/*
+ * Check that all pairs of this page and the middle key fit into "recipient"
+ * without filling it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                  const KeyType &middle_key) const -> bool {
+  if (!IsCompressed()) {
+    return true;
+  }
+  std::vector<MappingType> items = recipient->Entries()->GetItems(recipient->GetSize());
+  items.emplace_back(middle_key, ValueAt(0));
+  for (int i = 1; i < GetSize(); ++i) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return recipient->Entries()->GetAssignedSize(items, Entries()) + KeyArray::MAX_ENTRY_SIZE <=
+         recipient->Entries()->GetDataSize();
+}
+
+/*
+ * Share of the page that its children fill, by bytes in a compressed page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetFillRatio() const -> double {
+  if (IsCompressed()) {
+    return static_cast<double>(Entries()->GetUsedSize(GetSize())) / Entries()->GetDataSize();
+  }
+  return static_cast<double>(GetSize()) / GetMaxSize();
 }
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
+  if (IsCompressed()) {
+    return Entries()->KeyAt(index);
+  }
   KeyType key{array_[index].first};
   return key;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (IsCompressed()) {
+    Entries()->SetKeyAt(GetSize(), index, key);
+  } else {
+    array_[index].first = key;
+  }
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
@@ -66,10 +159,18 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const ->
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  return IsCompressed() ? Entries()->ValueAt(index) : array_[index].second;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (IsCompressed()) {
+    Entries()->SetValueAt(index, value);
+  } else {
+    array_[index].second = value;
+  }
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -111,6 +212,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyCompa
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
+  if (IsCompressed()) {
+    // The first key is never read, so an empty one takes the least room.
+    Entries()->Insert(0, 0, new_key, new_value);
+    Entries()->Insert(1, 0, KeyType{}, old_value);
+    SetSize(2);
+    return;
+  }
   SetValueAt(0, old_value);
   SetKeyAt(1, new_key);
   SetValueAt(1, new_value);
@@ -125,6 +233,11 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) -> int {
   int index = ValueIndex(old_value);
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), index + 1, new_key, new_value);
+    IncreaseSize(1);
+    return GetSize();
+  }
   for (int i = GetSize() - 1; i > index; --i) {
     array_[i + 1] = array_[i];
   }
@@ -139,16 +252,48 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * A compressed page moves the pairs past half of its bytes, as a compressed
+ * leaf page does.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
                                                 BufferPoolManager *buffer_pool_manager) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items = Entries()->GetItems(GetSize());
+    size_t half = Entries()->GetUsedSize(GetSize()) / 2;
+    int start = 0;
+    for (size_t used = 0; start < GetSize() - 1 && (start == 0 || used < half); ++start) {
+      used += Entries()->GetEntrySize(start);
+    }
+    std::vector<MappingType> moved(items.begin() + start, items.end());
+    items.resize(start);
+    recipient->Entries()->Assign(moved, Entries());
+    recipient->SetSize(static_cast<int>(moved.size()));
+    for (const auto &item : moved) {
+      recipient->Adopt(item.second, buffer_pool_manager);
+    }
+    Entries()->Assign(items, nullptr);
+    SetSize(start);
+    return;
+  }
+
   int size = GetSize();
   int start = GetMinSize();
   recipient->CopyNFrom(array_ + start, size - start, buffer_pool_manager);
   SetSize(start);
 }
 
+/*
+ * Make me the parent of child, persisting its new parent page id with the BufferPoolManger
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager) {
+  Page *child_page = buffer_pool_manager->FetchPage(child);
+  auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+  child_node->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+}
+
 /* Copy entries into me, starting from {items} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
@@ -177,6 +322,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
   int size = GetSize();
+  if (IsCompressed()) {
+    Entries()->Remove(size, index);
+    IncreaseSize(-1);
+    return;
+  }
   for (int i = index; i < size - 1; ++i) {
     array_[i] = array_[i + 1];
   }
@@ -205,6 +355,22 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items = recipient->Entries()->GetItems(recipient->GetSize());
+    items.emplace_back(middle_key, ValueAt(0));
+    for (int i = 1; i < GetSize(); ++i) {
+      items.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    recipient->Entries()->Assign(items, Entries());
+    for (int i = recipient->GetSize(); i < static_cast<int>(items.size()); ++i) {
+      recipient->Adopt(items[i].second, buffer_pool_manager);
+    }
+    recipient->SetSize(static_cast<int>(items.size()));
+    Entries()->Init(PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE);
+    SetSize(0);
+    return;
+  }
+
   SetKeyAt(0, middle_key);
   recipient->CopyNFrom(array_, GetSize(), buffer_pool_manager);
   SetSize(0);
@@ -224,8 +390,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
-  SetKeyAt(0, middle_key);
-  recipient->CopyLastFrom(array_[0], buffer_pool_manager);
+  recipient->CopyLastFrom({middle_key, ValueAt(0)}, buffer_pool_manager);
   Remove(0);
 }
 
@@ -235,7 +400,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  array_[GetSize()] = pair;
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), GetSize(), pair.first, pair.second);
+  } else {
+    array_[GetSize()] = pair;
+  }
   IncreaseSize(1);
 
   Page *child_page = buffer_pool_manager->FetchPage(ValueAt(GetSize() - 1));
@@ -255,8 +424,8 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
   recipient->SetKeyAt(0, middle_key);
-  recipient->CopyFirstFrom(array_[GetSize() - 1], buffer_pool_manager);
-  IncreaseSize(-1);
+  recipient->CopyFirstFrom({KeyAt(GetSize() - 1), ValueAt(GetSize() - 1)}, buffer_pool_manager);
+  Remove(GetSize() - 1);
 }
 
 /* Append an entry at the beginning.
@@ -265,11 +434,16 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  for (int i = GetSize() - 1; i >= 0; --i) {
-    array_[i + 1] = array_[i];
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), 0, pair.first, pair.second);
+    IncreaseSize(1);
+  } else {
+    for (int i = GetSize() - 1; i >= 0; --i) {
+      array_[i + 1] = array_[i];
+    }
+    IncreaseSize(1);
+    array_[0] = pair;
   }
-  IncreaseSize(1);
-  array_[0] = pair;
 
   Page *child_page = buffer_pool_manager->FetchPage(ValueAt(0));
   auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
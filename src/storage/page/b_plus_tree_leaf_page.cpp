@@ -27,13 +27,16 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  SetPageType(IndexPageType::LEAF_PAGE);
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool is_compressed) {
+  SetPageType(is_compressed ? IndexPageType::COMPRESSED_LEAF_PAGE : IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetMaxSize(max_size);
   SetParentPageId(parent_id);
   SetPageId(page_id);
   SetNextPageId(INVALID_PAGE_ID);
+  if (is_compressed) {
+    Entries()->Init(PAGE_SIZE - LEAF_PAGE_HEADER_SIZE);
+  }
 }
 
 /**
@@ -45,6 +48,71 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/*
+ * Helper methods to check the size of the page before and after a change.
+ * A plain page counts pairs against its max/min size. A compressed page
+ * counts bytes: an insert is safe if the page has room for two of the largest
+ * pairs, so that it is not full after it, and a remove is safe if the page
+ * keeps half of its bytes after the largest pair is gone.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToInsert() const -> bool {
+  if (IsCompressed()) {
+    return Entries()->GetFreeSize(GetSize()) >= 2 * KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() + 1 < GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsFull() const -> bool {
+  if (IsCompressed()) {
+    return Entries()->GetFreeSize(GetSize()) < KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() == GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToRemove() const -> bool {
+  if (IsCompressed()) {
+    return 2 * Entries()->GetUsedSize(GetSize()) >= Entries()->GetDataSize() + 2 * KeyArray::MAX_ENTRY_SIZE;
+  }
+  return GetSize() > GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const -> bool {
+  if (IsCompressed()) {
+    return 2 * Entries()->GetUsedSize(GetSize()) < Entries()->GetDataSize();
+  }
+  return GetSize() < GetMinSize();
+}
+
+/*
+ * Check that all pairs of this page fit into "recipient" without filling it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMoveAllTo(const BPlusTreeLeafPage *recipient) const -> bool {
+  if (!IsCompressed()) {
+    return true;
+  }
+  std::vector<MappingType> items = recipient->Entries()->GetItems(recipient->GetSize());
+  std::vector<MappingType> moved = Entries()->GetItems(GetSize());
+  items.insert(items.end(), moved.begin(), moved.end());
+  return recipient->Entries()->GetAssignedSize(items, Entries()) + KeyArray::MAX_ENTRY_SIZE <=
+         recipient->Entries()->GetDataSize();
+}
+
+/*
+ * Share of the page that its pairs fill, by bytes in a compressed page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetFillRatio() const -> double {
+  if (IsCompressed()) {
+    return static_cast<double>(Entries()->GetUsedSize(GetSize())) / Entries()->GetDataSize();
+  }
+  return static_cast<double>(GetSize()) / GetMaxSize();
+}
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
@@ -70,7 +138,9 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparato
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
+  if (IsCompressed()) {
+    return Entries()->KeyAt(index);
+  }
   KeyType key{array_[index].first};
   return key;
 }
@@ -80,8 +150,10 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> const MappingType & {
-  // replace with your own code
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> MappingType {
+  if (IsCompressed()) {
+    return {Entries()->KeyAt(index), Entries()->ValueAt(index)};
+  }
   return array_[index];
 }
 
@@ -100,6 +172,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
     return GetSize();
   }
 
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), index, key, value);
+    IncreaseSize(1);
+    return GetSize();
+  }
+
   for (int i = GetSize() - 1; i >= index; --i) {
     array_[i + 1] = array_[i];
   }
@@ -113,9 +191,27 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * A compressed page moves the pairs past half of its bytes, and both pages
+ * pick the prefix that suits their new keys.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items = Entries()->GetItems(GetSize());
+    size_t half = Entries()->GetUsedSize(GetSize()) / 2;
+    int start = 0;
+    for (size_t used = 0; start < GetSize() - 1 && (start == 0 || used < half); ++start) {
+      used += Entries()->GetEntrySize(start);
+    }
+    std::vector<MappingType> moved(items.begin() + start, items.end());
+    items.resize(start);
+    recipient->Entries()->Assign(moved, Entries());
+    recipient->SetSize(static_cast<int>(moved.size()));
+    Entries()->Assign(items, nullptr);
+    SetSize(start);
+    return;
+  }
+
   int size = GetSize();
   int start = GetMinSize();
   recipient->CopyNFrom(array_ + start, size - start);
@@ -144,7 +240,7 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
     -> bool {
   int index = KeyIndex(key, comparator);
   if (index < GetSize() && comparator(key, KeyAt(index)) == 0) {
-    *value = array_[index].second;
+    *value = IsCompressed() ? Entries()->ValueAt(index) : array_[index].second;
     return true;
   }
   return false;
@@ -164,8 +260,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
   int index = KeyIndex(key, comparator);
   int size = GetSize();
   if (index < size && comparator(key, KeyAt(index)) == 0) {
-    for (int i = index; i < size - 1; ++i) {
-      array_[i] = array_[i + 1];
+    if (IsCompressed()) {
+      Entries()->Remove(size, index);
+    } else {
+      for (int i = index; i < size - 1; ++i) {
+        array_[i] = array_[i + 1];
+      }
     }
 
     IncreaseSize(-1);
@@ -183,6 +283,17 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items = recipient->Entries()->GetItems(recipient->GetSize());
+    std::vector<MappingType> moved = Entries()->GetItems(GetSize());
+    items.insert(items.end(), moved.begin(), moved.end());
+    recipient->Entries()->Assign(items, Entries());
+    recipient->SetSize(static_cast<int>(items.size()));
+    Entries()->Init(PAGE_SIZE - LEAF_PAGE_HEADER_SIZE);
+    SetSize(0);
+    return;
+  }
+
   recipient->CopyNFrom(array_, GetSize());
   SetSize(0);
 }
@@ -195,10 +306,14 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyLastFrom(array_[0]);
+  recipient->CopyLastFrom(GetItem(0));
   int size = GetSize();
-  for (int i = 1; i < size; ++i) {
-    array_[i - 1] = array_[i];
+  if (IsCompressed()) {
+    Entries()->Remove(size, 0);
+  } else {
+    for (int i = 1; i < size; ++i) {
+      array_[i - 1] = array_[i];
+    }
   }
   IncreaseSize(-1);
 }
@@ -208,7 +323,11 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  array_[GetSize()] = item;
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), GetSize(), item.first, item.second);
+  } else {
+    array_[GetSize()] = item;
+  }
   IncreaseSize(1);
 }
 
@@ -217,7 +336,10 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyFirstFrom(array_[GetSize() - 1]);
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
+  if (IsCompressed()) {
+    Entries()->Remove(GetSize(), GetSize() - 1);
+  }
   IncreaseSize(-1);
 }
 
@@ -226,6 +348,11 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  if (IsCompressed()) {
+    Entries()->Insert(GetSize(), 0, item.first, item.second);
+    IncreaseSize(1);
+    return;
+  }
   for (int i = GetSize() - 1; i >= 0; --i) {
     array_[i + 1] = array_[i];
   }
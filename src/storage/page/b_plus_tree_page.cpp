@@ -17,7 +17,9 @@ namespace bustub {
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
  */
-auto BPlusTreePage::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
+auto BPlusTreePage::IsLeafPage() const -> bool {
+  return page_type_ == IndexPageType::LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE;
+}
 auto BPlusTreePage::IsRootPage() const -> bool { return parent_page_id_ == INVALID_PAGE_ID; }
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
@@ -58,4 +60,11 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+/*
+ * Helper method to get the page format, which is part of the page type
+ */
+auto BPlusTreePage::IsCompressed() const -> bool {
+  return page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_INTERNAL_PAGE;
+}
+
 }  // namespace bustub
@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_key_array.cpp
+//
+// Identification: src/storage/page/compressed_key_array.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/compressed_key_array.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::Init(size_t size) {
+  size_ = size;
+  heap_start_ = size;
+  prefix_length_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::GetEntrySize(int index) const -> size_t {
+  auto *entry = reinterpret_cast<const uint8_t *>(Data() + Slots()[index]);
+  return sizeof(uint16_t) + 2 + entry[1] + sizeof(ValueType);
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::GetEntrySize(const KeyType &key) const -> size_t {
+  size_t length = KeyLength(key);
+  size_t shared = CommonPrefixLength(reinterpret_cast<const char *>(&key), length, prefix_, prefix_length_);
+  return sizeof(uint16_t) + 2 + length - shared + sizeof(ValueType);
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::KeyAt(int index) const -> KeyType {
+  auto *entry = reinterpret_cast<const uint8_t *>(Data() + Slots()[index]);
+  KeyType key;
+  auto *bytes = reinterpret_cast<char *>(&key);
+  memset(bytes, 0, sizeof(KeyType));
+  memcpy(bytes, prefix_, entry[0]);
+  memcpy(bytes + entry[0], entry + 2, entry[1]);
+  return key;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::ValueAt(int index) const -> ValueType {
+  auto *entry = reinterpret_cast<const uint8_t *>(Data() + Slots()[index]);
+  ValueType value;
+  memcpy(reinterpret_cast<char *>(&value), entry + 2 + entry[1], sizeof(ValueType));
+  return value;
+}
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::SetValueAt(int index, const ValueType &value) {
+  auto *entry = reinterpret_cast<uint8_t *>(Data() + Slots()[index]);
+  memcpy(entry + 2 + entry[1], reinterpret_cast<const char *>(&value), sizeof(ValueType));
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::GetItems(int num_entries) const -> std::vector<MappingType> {
+  std::vector<MappingType> items;
+  items.reserve(num_entries);
+  for (int i = 0; i < num_entries; ++i) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::Insert(int num_entries, int index, const KeyType &key, const ValueType &value) {
+  if (num_entries == 0) {
+    heap_start_ = size_;
+    prefix_length_ = KeyLength(key);
+    memcpy(prefix_, reinterpret_cast<const char *>(&key), prefix_length_);
+  }
+  uint16_t *slots = Slots();
+  memmove(slots + index + 1, slots + index, (num_entries - index) * sizeof(uint16_t));
+  slots[index] = AppendEntry(key, value);
+}
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::Remove(int num_entries, int index) {
+  uint16_t *slots = Slots();
+  uint16_t offset = slots[index];
+  size_t entry_size = GetEntrySize(index) - sizeof(uint16_t);
+  // Entries in front of the removed one move up over it.
+  memmove(Data() + heap_start_ + entry_size, Data() + heap_start_, offset - heap_start_);
+  for (int i = 0; i < num_entries; ++i) {
+    if (slots[i] < offset) {
+      slots[i] += entry_size;
+    }
+  }
+  heap_start_ += entry_size;
+  memmove(slots + index, slots + index + 1, (num_entries - index - 1) * sizeof(uint16_t));
+}
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::SetKeyAt(int num_entries, int index, const KeyType &key) {
+  ValueType value = ValueAt(index);
+  Remove(num_entries, index);
+  Insert(num_entries - 1, index, key, value);
+}
+
+template <typename KeyType, typename ValueType>
+void COMPRESSED_KEY_ARRAY_TYPE::Assign(const std::vector<MappingType> &items, const CompressedKeyArray *other) {
+  std::vector<char> prefix = ChoosePrefix(items, other).first;
+  heap_start_ = size_;
+  prefix_length_ = prefix.size();
+  std::copy(prefix.begin(), prefix.end(), prefix_);
+  for (size_t i = 0; i < items.size(); ++i) {
+    Slots()[i] = AppendEntry(items[i].first, items[i].second);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::GetAssignedSize(const std::vector<MappingType> &items,
+                                                const CompressedKeyArray *other) const -> size_t {
+  return ChoosePrefix(items, other).second;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::KeyLength(const KeyType &key) -> size_t {
+  auto *bytes = reinterpret_cast<const char *>(&key);
+  size_t length = sizeof(KeyType);
+  while (length > 0 && bytes[length - 1] == 0) {
+    --length;
+  }
+  return length;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::CommonPrefixLength(const char *a, size_t a_length, const char *b, size_t b_length)
+    -> size_t {
+  size_t length = std::min(a_length, b_length);
+  size_t i = 0;
+  while (i < length && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::ChoosePrefix(const std::vector<MappingType> &items,
+                                             const CompressedKeyArray *other) const
+    -> std::pair<std::vector<char>, size_t> {
+  std::vector<size_t> lengths;
+  lengths.reserve(items.size());
+  for (const auto &item : items) {
+    lengths.push_back(KeyLength(item.first));
+  }
+
+  // The current prefixes are kept if they still fit the keys. Otherwise the common prefix of all keys is, or of all
+  // but the first one, which in an internal page is not a real key.
+  std::vector<std::pair<const char *, size_t>> candidates{{prefix_, prefix_length_}};
+  if (other != nullptr) {
+    candidates.emplace_back(other->prefix_, other->prefix_length_);
+  }
+  for (size_t first = 0; first < std::min<size_t>(items.size(), 2); ++first) {
+    const char *prefix = reinterpret_cast<const char *>(&items[first].first);
+    size_t prefix_length = lengths[first];
+    for (size_t i = first + 1; i < items.size(); ++i) {
+      prefix_length =
+          CommonPrefixLength(prefix, prefix_length, reinterpret_cast<const char *>(&items[i].first), lengths[i]);
+    }
+    candidates.emplace_back(prefix, prefix_length);
+  }
+
+  std::pair<std::vector<char>, size_t> best{{}, SIZE_MAX};
+  for (const auto &[prefix, prefix_length] : candidates) {
+    size_t used = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+      size_t shared =
+          CommonPrefixLength(reinterpret_cast<const char *>(&items[i].first), lengths[i], prefix, prefix_length);
+      used += sizeof(uint16_t) + 2 + lengths[i] - shared + sizeof(ValueType);
+    }
+    if (used < best.second) {
+      best = {std::vector<char>(prefix, prefix + prefix_length), used};
+    }
+  }
+  return best;
+}
+
+template <typename KeyType, typename ValueType>
+auto COMPRESSED_KEY_ARRAY_TYPE::AppendEntry(const KeyType &key, const ValueType &value) -> uint16_t {
+  auto *bytes = reinterpret_cast<const char *>(&key);
+  size_t length = KeyLength(key);
+  size_t shared = CommonPrefixLength(bytes, length, prefix_, prefix_length_);
+  heap_start_ -= 2 + length - shared + sizeof(ValueType);
+  auto *entry = reinterpret_cast<uint8_t *>(Data() + heap_start_);
+  entry[0] = static_cast<uint8_t>(shared);
+  entry[1] = static_cast<uint8_t>(length - shared);
+  memcpy(entry + 2, bytes + shared, length - shared);
+  memcpy(entry + 2 + length - shared, reinterpret_cast<const char *>(&value), sizeof(ValueType));
+  return heap_start_;
+}
+
+template class CompressedKeyArray<GenericKey<4>, RID>;
+template class CompressedKeyArray<GenericKey<8>, RID>;
+template class CompressedKeyArray<GenericKey<16>, RID>;
+template class CompressedKeyArray<GenericKey<32>, RID>;
+template class CompressedKeyArray<GenericKey<64>, RID>;
+
+template class CompressedKeyArray<GenericKey<4>, page_id_t>;
+template class CompressedKeyArray<GenericKey<8>, page_id_t>;
+template class CompressedKeyArray<GenericKey<16>, page_id_t>;
+template class CompressedKeyArray<GenericKey<32>, page_id_t>;
+template class CompressedKeyArray<GenericKey<64>, page_id_t>;
+
+}  // namespace bustub
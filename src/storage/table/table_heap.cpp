@@ -13,6 +13,7 @@
 #include <cassert>
 
 #include "common/logger.h"
+#include "storage/disk/disk_manager.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -24,11 +25,14 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
       log_manager_(log_manager),
       first_page_id_(first_page_id) {}
 
+TableHeap::~TableHeap() { DiskManager::RetireOwner(owner_id_); }
+
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page =
+      reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPageNear(&first_page_id_, INVALID_PAGE_ID, owner_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
@@ -63,7 +67,9 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      // The pages of the table are allocated in extents, which keeps sequential scans mostly sequential on disk.
+      auto new_page = static_cast<TablePage *>(
+          buffer_pool_manager_->NewPageNear(&next_page_id, cur_page->GetTablePageId(), owner_id_));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -153,9 +159,9 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), access_type));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -169,24 +175,26 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, AccessType access_type) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, access_type));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto next_page_id = page->GetNextPageId();
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
+      buffer_pool_manager_->PrefetchPage(next_page_id, access_type);
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, access_type);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -16,10 +16,10 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, AccessType access_type)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), access_type_(access_type) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, access_type_);
   }
 }
 
@@ -35,7 +35,7 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), access_type_));
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
@@ -43,11 +43,13 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), access_type_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      // The chain is only known one page ahead, so start reading the page after this one while it is scanned.
+      buffer_pool_manager->PrefetchPage(cur_page->GetNextPageId(), access_type_);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -56,7 +58,7 @@ TableIterator &TableIterator::operator++() {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, access_type_);
   }
   // release until copy the tuple
   cur_page->RUnlatch();
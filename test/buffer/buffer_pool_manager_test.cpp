@@ -10,11 +10,24 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_slow.h"
 
 namespace bustub {
 
@@ -29,7 +42,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -91,7 +104,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -141,4 +154,1042 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Many threads missing on a small pool, so that evictions and reads overlap with the latch released
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const int num_pages = 50;
+  const int num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Every thread holds at most one pin, so there is always a frame to evict.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < 1000; ++i) {
+        page_id_t page_id = dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** @return true if the page is resident in the buffer pool */
+bool IsResident(BufferPoolManagerInstance *bpm, page_id_t page_id) {
+  Page *pages = bpm->GetPages();
+  return std::any_of(pages, pages + bpm->GetPoolSize(), [&](Page &page) { return page.GetPageId() == page_id; });
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_hot_pages = 10;
+  const int num_scan_pages = 100;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a sequential scan that is much larger than the pool only recycles its ring, dirtying every other page.
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id, AccessType::SequentialScan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    if (page_id % 2 == 0) {
+      snprintf(page->GetData(), PAGE_SIZE, "scanned-%d", page_id);
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, page_id % 2 == 0));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_TRUE(IsResident(bpm, page_id));
+  }
+
+  // Scenario: pages written by the scan were written back when their ring frame was recycled.
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id, AccessType::BulkWrite);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ((page_id % 2 == 0 ? "scanned-" : "page-") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a page read by a scan and then used normally is handed to the replacer and survives the next scan.
+  page_id_t promoted = num_hot_pages + num_scan_pages - 1;
+  ASSERT_NE(nullptr, bpm->FetchPage(promoted));
+  EXPECT_EQ(true, bpm->UnpinPage(promoted, false));
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages - 1; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::SequentialScan));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(IsResident(bpm, promoted));
+
+  // Scenario: when every other frame is pinned, frames are taken back from the rings.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(nullptr, bpm->FetchPage(0, AccessType::SequentialScan));
+  for (auto pinned_page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+
+  auto dirty_all = [&] {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData() + sizeof(page_id_t) + sizeof(lsn_t), PAGE_SIZE / 2, "page-%d", page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  };
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  dirty_all();
+
+  // Scenario: one round cleans the next victims of the replacer first, so new pages evict them without a write.
+  EXPECT_EQ(3, bpm->WriteBackDirtyPages(1.0, 3));
+  EXPECT_EQ(3, bpm->GetNumBackgroundWrites());
+  for (int i = 0; i < 3; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+
+  // Scenario: the next victims are clean now, but other pages are cleaned until at most dirty_ratio of the pool is
+  // dirty. Touching pages 3-9 leaves the three new, clean pages as the next victims.
+  for (page_id_t page_id = 3; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(2, bpm->WriteBackDirtyPages(0.5, 3));
+  EXPECT_EQ(5, bpm->WriteBackDirtyPages(0.0, buffer_pool_size));
+  EXPECT_EQ(0, bpm->WriteBackDirtyPages(0.0, buffer_pool_size));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData() + sizeof(page_id_t) + sizeof(lsn_t)));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: with logging enabled, a page is only written once its LSN is persistent.
+  enable_logging = true;
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  page->SetLSN(5);
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  log_manager->SetPersistentLSN(4);
+  EXPECT_EQ(0, bpm->WriteBackDirtyPages(0.0, buffer_pool_size));
+  log_manager->SetPersistentLSN(5);
+  EXPECT_EQ(1, bpm->WriteBackDirtyPages(0.0, buffer_pool_size));
+  enable_logging = false;
+
+  // Scenario: the background thread keeps the pool clean on its own.
+  dirty_all();
+  bpm->StartBackgroundWriter(0.0, buffer_pool_size);
+  for (int i = 0; i < 1000 && bpm->GetNumBackgroundWrites() < 11 + buffer_pool_size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(11 + buffer_pool_size, bpm->GetNumBackgroundWrites());
+  EXPECT_EQ(0, bpm->WriteBackDirtyPages(0.0, buffer_pool_size));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Pages 0-9 are on disk, pages 10-19 are resident.
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: resident and invalid pages are skipped, the others get a frame right away and are read in the
+  // background. A later fetch finds them.
+  bpm->PrefetchPages({0, INVALID_PAGE_ID, 15, 1});
+  EXPECT_TRUE(IsResident(bpm, 0));
+  EXPECT_TRUE(IsResident(bpm, 1));
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page-0", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: prefetched pages are not pinned.
+  EXPECT_EQ(false, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+
+  // Scenario: at most a quarter of the pool is taken up by prefetches that are still in flight.
+  bpm->PrefetchPages({3, 4, 5, 6, 7});
+  EXPECT_TRUE(IsResident(bpm, 3));
+  EXPECT_TRUE(IsResident(bpm, 4));
+  EXPECT_FALSE(IsResident(bpm, 5));
+
+  // Scenario: pages that are prefetched but never fetched can be evicted.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (auto pinned_page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+  }
+  for (page_id_t page_id = 2; page_id < 8; ++page_id) {
+    page = bpm->FetchPage(page_id, AccessType::SequentialScan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchRaceTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = buffer_pool_size * 4;
+
+  auto *disk_manager = new DiskManagerMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a page is fetched and unpinned by another thread while it is still being prefetched. Once its read is
+  // done, its frame can be evicted like any other.
+  for (size_t round = 0; round < 200; ++round) {
+    auto page_id = static_cast<page_id_t>(round * 7 % num_pages);
+    bpm->PrefetchPages({page_id});
+    std::thread fetcher([&] {
+      for (int i = 0; i < 100; ++i) {
+        if (bpm->FetchPage(page_id) != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+    fetcher.join();
+
+    std::vector<page_id_t> pinned;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t new_page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+      pinned.push_back(new_page_id);
+    }
+    for (auto pinned_page_id : pinned) {
+      EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+      EXPECT_EQ(true, bpm->DeletePage(pinned_page_id));
+    }
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+// Latency of FetchPage + UnpinPage on resident pages, i.e. the hit path. Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const std::string db_name = "test.db";
+  // Large enough to span more than one huge page.
+  const size_t buffer_pool_size = 1024;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  Page *pages = bpm->GetPages();
+
+  // Scenario: the frames are one contiguous, page-aligned block that starts on a huge page boundary.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[0].GetData()) % FrameArena::HUGE_PAGE_SIZE);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % PAGE_SIZE);
+    EXPECT_EQ(pages[0].GetData() + i * PAGE_SIZE, pages[i].GetData());
+  }
+
+  // Scenario: the metadata of every frame starts on its own cache line and lies outside the frame data.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&pages[0]) % 64);
+  EXPECT_EQ(0, sizeof(Page) % 64);
+  auto *metadata_begin = reinterpret_cast<char *>(&pages[0]);
+  auto *metadata_end = reinterpret_cast<char *>(&pages[buffer_pool_size]);
+  auto *data_end = pages[0].GetData() + buffer_pool_size * PAGE_SIZE;
+  EXPECT_TRUE(metadata_end <= pages[0].GetData() || metadata_begin >= data_end);
+
+  // Scenario: pages round-trip through the arena like before.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size + 1; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page-0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t max_pool_size = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+
+  // Fill the pool. Frames are handed out in order, so page 9 is in frame 9.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+  }
+  for (page_id_t i = 0; i < 9; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: sizes of 0 and beyond the maximum are refused.
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: shrinking waits for the pinned page in a frame that goes away.
+  std::atomic<bool> resized{false};
+  std::thread resizer([&] {
+    EXPECT_TRUE(bpm->Resize(5));
+    resized = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(resized);
+  // Fetching the page meanwhile still works and does not let the resize finish early.
+  auto *retiring_page = bpm->FetchPage(9);
+  ASSERT_NE(nullptr, retiring_page);
+  EXPECT_EQ(std::string("page-9"), retiring_page->GetData());
+  EXPECT_EQ(true, bpm->UnpinPage(9, false));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(resized);
+  // The last unpin wakes up the resize.
+  EXPECT_EQ(true, bpm->UnpinPage(9, true));
+  resizer.join();
+  EXPECT_EQ(5, bpm->GetPoolSize());
+
+  // Scenario: the pages of the frames that went away were written back. Only 5 of them fit at once now.
+  std::vector<Page *> pinned;
+  for (page_id_t i = 5; i < 10; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    pinned.push_back(page);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: growing adds free frames, even while every frame is pinned.
+  EXPECT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (page_id_t i = 0; i < 5; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+  }
+  for (size_t i = 10; i < max_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeStressTest) {
+  const std::string db_name = "test.db";
+  const size_t min_pool_size = 8;
+  const size_t max_pool_size = 64;
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 32;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(max_pool_size / 2, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+
+  // Every thread owns some pages and keeps a counter in each. Every fetch checks that no update was lost while the
+  // pool was resized underneath.
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    for (size_t i = 0; i < pages_per_thread; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      *reinterpret_cast<uint64_t *>(page->GetData()) = 0;
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      page_ids[tid].push_back(page_id);
+    }
+  }
+
+  bpm->StartBackgroundWriter();
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::vector<uint64_t> counters(pages_per_thread, 0);
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, pages_per_thread - 1);
+      while (!stop) {
+        size_t i = dist(rng);
+        // Each thread pins one page at a time, so some frame is always free enough to make progress. Some fetches go
+        // through the scan ring.
+        auto access_type = i % 4 == 0 ? AccessType::SequentialScan : AccessType::Normal;
+        auto *page = bpm->FetchPage(page_ids[tid][i], access_type);
+        if (page == nullptr) {
+          continue;
+        }
+        auto *counter = reinterpret_cast<uint64_t *>(page->GetData());
+        EXPECT_EQ(counters[i], *counter);
+        *counter = ++counters[i];
+        EXPECT_EQ(true, bpm->UnpinPage(page_ids[tid][i], true));
+      }
+    });
+  }
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<size_t> size_dist(min_pool_size, max_pool_size);
+  for (int round = 0; round < 50; ++round) {
+    size_t new_pool_size = size_dist(rng);
+    EXPECT_TRUE(bpm->Resize(new_pool_size));
+    EXPECT_EQ(new_pool_size, bpm->GetPoolSize());
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bpm->StopBackgroundWriter();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const std::string warm_file_name = "test.warm";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Pages 20-29 end up resident. Page 25 is used last, then 24, 23, and so on.
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t i = 29; i >= 25; --i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  bpm->FlushAllPages();
+  bpm->SaveResidentPages(warm_file_name);
+  delete bpm;
+
+  // Scenario: a pool of the same size loads all of them back, with one read for the whole run.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  int num_reads = disk_manager->GetNumReads();
+  bpm->WarmUp(warm_file_name);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumWarmedPages());
+  for (page_id_t i = 20; i < num_pages; ++i) {
+    EXPECT_TRUE(IsResident(bpm, i));
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+  delete bpm;
+
+  // Scenario: a smaller pool loads the most recently used pages.
+  bpm = new BufferPoolManagerInstance(5, disk_manager);
+  bpm->WarmUp(warm_file_name);
+  bpm->WaitForWarmUp();
+  for (page_id_t i = 25; i < 30; ++i) {
+    EXPECT_TRUE(IsResident(bpm, i));
+  }
+  delete bpm;
+
+  // Scenario: pages fetched during the warmup are not loaded twice, and the warmup never evicts them.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  bpm->WarmUp(warm_file_name);
+  for (page_id_t i = 20; i < num_pages; ++i) {
+    auto *warm_page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, warm_page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(warm_page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  bpm->WaitForWarmUp();
+  EXPECT_TRUE(IsResident(bpm, 0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  delete bpm;
+
+  // Scenario: a missing or malformed file is ignored.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  remove(warm_file_name.c_str());
+  bpm->WarmUp(warm_file_name);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(0, bpm->GetNumWarmedPages());
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Frames are handed out in order, so the dirty pages are spread over the frames out of page id order.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t i : {7, 2, 9, 0, 8, 1}) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: pages 0-2 and 7-9 are written with one write each, and every page is clean afterwards.
+  int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 2, disk_manager->GetNumWrites());
+  Page *pages = bpm->GetPages();
+  EXPECT_TRUE(std::none_of(pages, pages + buffer_pool_size, [](Page &page) { return page.IsDirty(); }));
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 2, disk_manager->GetNumWrites());
+
+  char data[PAGE_SIZE];
+  for (page_id_t i : {0, 1, 2, 7, 8, 9}) {
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(data));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->EnableCompressedCache(PAGE_SIZE * 10);
+
+  // Pages 0-4 are evicted by pages 5-9. The dirty ones are written back as usual.
+  page_id_t page_id;
+  for (int i = 0; i < 10; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+  }
+
+  // Scenario: evicted pages come back from the cache, without reading from disk, dirty or not.
+  int num_reads = disk_manager->GetNumReads();
+  for (page_id_t i = 0; i < 5; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+  CompressedCacheStats stats = bpm->GetCompressedCacheStats();
+  EXPECT_EQ(5, stats.num_hits_);
+  EXPECT_GT(stats.GetCompressionRatio(), 10);
+
+  // Scenario: a page that was read back in and changed is not served from an old copy later.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "changed");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  for (page_id_t i = 5; i < 10; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("changed", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: a deleted page is not served from the cache.
+  for (page_id_t i = 1; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(9));
+  num_reads = disk_manager->GetNumReads();
+  ASSERT_NE(nullptr, bpm->FetchPage(9));
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+  EXPECT_EQ(true, bpm->UnpinPage(9, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeletedPageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(i, page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: pages deleted while resident and while on disk only are both reused, lowest first.
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // Scenario: a page created near another one takes the free page closest to it.
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  ASSERT_NE(nullptr, bpm->NewPageNear(&page_id, 5));
+  EXPECT_EQ(6, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(8, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // Scenario: a deleted page fetched again under its stale id keeps the id from being handed out while it is pinned.
+  // Once it is unpinned, the copy is dropped and the id is reused.
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(9, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(3, page_id);
+  EXPECT_EQ(page, bpm->FetchPage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeleteEvictingPageTest) {
+  DiskManagerMemory memory;
+  SlowDiskOptions options;
+  options.write_latency_ = std::chrono::milliseconds(200);
+  DiskManagerSlow disk_manager(&memory, options);
+  BufferPoolManagerInstance bpm(1, &disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm.NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "old");
+  EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+
+  // Scenario: page 0 is deleted while it is written back as a victim. The delete waits for the write, which could
+  // otherwise land after the id was allocated again.
+  std::thread evictor([&] {
+    page_id_t new_page_id;
+    ASSERT_NE(nullptr, bpm.NewPage(&new_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(new_page_id, false));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(true, bpm.DeletePage(0));
+  std::vector<char> data(PAGE_SIZE);
+  memory.ReadPage(0, data.data());
+  EXPECT_STREQ("old", data.data());
+  evictor.join();
+
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MemoryBackendTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = buffer_pool_size * 4;
+
+  auto *disk_manager = new DiskManagerMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: pages evicted to the in-memory backend come back with their data, without any file.
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%zu", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_ids[i] = static_cast<page_id_t>(i);
+  }
+  bpm->PrefetchPages(page_ids);
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(static_cast<page_id_t>(i));
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page-" + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(i), false));
+  }
+  EXPECT_LT(0, disk_manager->GetNumWrites());
+  EXPECT_EQ(false, access("test.db", F_OK) == 0);
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_HitPathBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const auto duration = std::chrono::milliseconds(500);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    page_ids.push_back(page_id);
+  }
+
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total_ops{0};
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+        uint64_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          page_id_t page_id = page_ids[dist(rng)];
+          bpm->FetchPage(page_id);
+          bpm->UnpinPage(page_id, false);
+          ++ops;
+        }
+        total_ops += ops;
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::cout << "threads=" << num_threads << " fetch+unpin/sec=" << total_ops * 1000 / duration.count()
+              << " ns/op per thread=" << static_cast<double>(elapsed_ns) * num_threads / total_ops << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Cycles through a working set half again as large as the pool, with and without a compressed cache that holds a
+// third of the pool uncompressed, and reports the disk reads, the hit rate and the compression ratio.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_CompressedCacheBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = buffer_pool_size * 3 / 2;
+  const int num_rounds = 20;
+
+  for (bool enable_cache : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    if (enable_cache) {
+      bpm->EnableCompressedCache(buffer_pool_size / 3 * PAGE_SIZE);
+    }
+    // Table pages: fixed-size tuples with a few distinct values per column, filling two thirds of the page.
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      for (size_t slot = 0; slot < PAGE_SIZE * 2 / 3 / 64; ++slot) {
+        snprintf(page->GetData() + slot * 64, 64, "%06zu|%03zu|order-status-%zu|2021-%02zu-%02zu|%zu.99",
+                 i * 100 + slot, slot % 50, slot % 3, slot % 12 + 1, slot % 28 + 1, slot * 7 % 1000);
+      }
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+
+    int num_reads = disk_manager->GetNumReads();
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages) - 1);
+    for (int round = 0; round < num_rounds; ++round) {
+      for (size_t i = 0; i < num_pages; ++i) {
+        page_id_t page_id = dist(rng);
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    CompressedCacheStats stats = bpm->GetCompressedCacheStats();
+    std::cout << "compressed_cache=" << enable_cache << " disk_reads=" << disk_manager->GetNumReads() - num_reads
+              << " hit_rate=" << stats.GetHitRate() << " compression_ratio=" << stats.GetCompressionRatio()
+              << " ms=" << elapsed.count() << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// Random fetches over a file four times the size of the pool, with buffered I/O and with O_DIRECT, starting from a
+// cold page cache. Reports the fetch rate and how much of the file the page cache holds afterwards, which direct I/O
+// keeps from caching what the pool already caches.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_DirectIoBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1024;
+  const size_t num_pages = buffer_pool_size * 4;
+  const size_t num_fetches = 50000;
+
+  for (bool direct_io : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name, direct_io);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page-%zu", i);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+
+    int fd = open(db_name.c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages) - 1);
+    for (size_t i = 0; i < num_fetches; ++i) {
+      page_id_t page_id = dist(rng);
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    // Pages of the file in the page cache.
+    size_t file_size = num_pages * PAGE_SIZE;
+    void *map = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    ASSERT_NE(MAP_FAILED, map);
+    auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> resident((file_size + os_page_size - 1) / os_page_size);
+    ASSERT_EQ(0, mincore(map, file_size, resident.data()));
+    size_t cached_kb = std::count_if(resident.begin(), resident.end(), [](unsigned char r) { return (r & 1) != 0; }) *
+                       os_page_size / 1024;
+    munmap(map, file_size);
+    close(fd);
+
+    std::cout << "direct_io=" << disk_manager->IsDirectIo()
+              << " fetches/sec=" << num_fetches * 1000000 / elapsed.count() << " misses=" << bpm->GetNumMisses()
+              << " pool_kb=" << buffer_pool_size * PAGE_SIZE / 1024
+              << " page_cache_kb=" << cached_kb << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// Fetches per second of a pool that misses most of the time, on the in-memory backend and under SSD and HDD timings,
+// with one thread and with several threads whose misses overlap. Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_SlowDiskBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = buffer_pool_size * 16;
+  const size_t num_threads = 8;
+  const auto duration = std::chrono::seconds(2);
+
+  struct Device {
+    const char *name_;
+    std::optional<SlowDiskOptions> options_;
+  };
+  for (const auto &device :
+       {Device{"memory", std::nullopt}, Device{"ssd", SlowDiskOptions::Ssd()}, Device{"hdd", SlowDiskOptions::Hdd()}}) {
+    for (size_t threads : {size_t{1}, num_threads}) {
+      DiskManagerMemory memory;
+      std::unique_ptr<DiskManagerSlow> slow;
+      DiskManager *disk_manager = &memory;
+      if (device.options_.has_value()) {
+        slow = std::make_unique<DiskManagerSlow>(&memory, *device.options_);
+        disk_manager = slow.get();
+      }
+      // Fill the backend directly, so that only the fetches pay the simulated timings.
+      std::vector<char> data(PAGE_SIZE, 'x');
+      for (size_t i = 0; i < num_pages; ++i) {
+        memory.AllocatePage();
+        memory.WritePage(static_cast<page_id_t>(i), data.data());
+      }
+      BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+
+      std::atomic<size_t> num_fetches{0};
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+          std::mt19937 rng(t);
+          std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages) - 1);
+          while (std::chrono::steady_clock::now() - start < duration) {
+            page_id_t page_id = dist(rng);
+            auto *page = bpm.FetchPage(page_id);
+            if (page != nullptr) {
+              bpm.UnpinPage(page_id, false);
+              num_fetches.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << "device=" << device.name_ << " threads=" << threads
+                << " fetches/sec=" << num_fetches.load() * 1000000 / elapsed.count()
+                << " misses=" << bpm.GetNumMisses() << std::endl;
+    }
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set_test.cpp
+//
+// Identification: test/buffer/buffer_pool_set_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_set.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolSetTest, SampleTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *pools = new BufferPoolSet(disk_manager);
+  auto *index_pool = pools->AddPool(BufferPoolSet::INDEX_POOL, 8, ReplacerType::LRU_K);
+  auto *heap_pool = pools->AddPool(BufferPoolSet::HEAP_POOL, 4, ReplacerType::LRU, 16);
+
+  EXPECT_EQ(index_pool, pools->GetPool(BufferPoolSet::INDEX_POOL));
+  EXPECT_TRUE(pools->HasPool(BufferPoolSet::HEAP_POOL));
+  EXPECT_FALSE(pools->HasPool(BufferPoolSet::TEMP_POOL));
+  EXPECT_THROW(pools->GetPool(BufferPoolSet::TEMP_POOL), std::out_of_range);
+  EXPECT_EQ((std::vector<std::string>{"heap", "index"}), pools->GetPoolNames());
+  EXPECT_EQ(12, pools->GetTotalPoolSize());
+
+  // The index fills its pool, the table is four times as large as its own.
+  std::vector<page_id_t> index_pages;
+  std::vector<page_id_t> heap_pages;
+  page_id_t page_id;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = index_pool->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "index-%d", page_id);
+    EXPECT_EQ(true, index_pool->UnpinPage(page_id, true));
+    index_pages.push_back(page_id);
+  }
+  for (int i = 0; i < 16; ++i) {
+    auto *page = heap_pool->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "heap-%d", page_id);
+    EXPECT_EQ(true, heap_pool->UnpinPage(page_id, true));
+    heap_pages.push_back(page_id);
+  }
+
+  // Scenario: scanning the table over and over does not evict a single index page.
+  for (int round = 0; round < 3; ++round) {
+    for (auto heap_page_id : heap_pages) {
+      auto *page = heap_pool->FetchPage(heap_page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("heap-" + std::to_string(heap_page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, heap_pool->UnpinPage(heap_page_id, false));
+    }
+  }
+  for (auto index_page_id : index_pages) {
+    auto *page = index_pool->FetchPage(index_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("index-" + std::to_string(index_page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, index_pool->UnpinPage(index_page_id, false));
+  }
+
+  // Scenario: the stats are kept per pool.
+  BufferPoolStats index_stats = pools->GetStats(BufferPoolSet::INDEX_POOL);
+  BufferPoolStats heap_stats = pools->GetStats(BufferPoolSet::HEAP_POOL);
+  EXPECT_EQ(8, index_stats.pool_size_);
+  EXPECT_EQ(0, index_stats.num_misses_);
+  EXPECT_EQ(0, index_stats.num_foreground_writes_);
+  EXPECT_EQ(48, heap_stats.num_misses_);
+  EXPECT_EQ(16, heap_stats.num_foreground_writes_);
+
+  // Scenario: memory moves from one pool to another.
+  EXPECT_TRUE(pools->ResizePool(BufferPoolSet::INDEX_POOL, 4));
+  EXPECT_TRUE(pools->ResizePool(BufferPoolSet::HEAP_POOL, 8));
+  EXPECT_FALSE(pools->ResizePool(BufferPoolSet::HEAP_POOL, 32));
+  EXPECT_EQ(12, pools->GetTotalPoolSize());
+
+  pools->FlushAllPages();
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(index_pages.back(), data);
+  EXPECT_EQ("index-" + std::to_string(index_pages.back()), std::string(data));
+
+  delete pools;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
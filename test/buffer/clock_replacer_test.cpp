@@ -10,16 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "buffer/clock_replacer.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +62,86 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const size_t num_frames = 64;
+  const int num_threads = 4;
+  ClockReplacer clock_replacer(num_frames);
+
+  // Every thread owns a disjoint set of frames and keeps unpinning and pinning them, leaving them unpinned.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (int round = 0; round < 1000; ++round) {
+        for (auto frame_id = static_cast<frame_id_t>(tid); frame_id < static_cast<frame_id_t>(num_frames);
+             frame_id += num_threads) {
+          clock_replacer.Unpin(frame_id);
+          clock_replacer.Pin(frame_id);
+          clock_replacer.Unpin(frame_id);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_frames, clock_replacer.Size());
+
+  // Then all threads evict at the same time.
+  threads.clear();
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      frame_id_t frame_id;
+      while (clock_replacer.Victim(&frame_id)) {
+        victims[tid].push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every frame was handed out exactly once.
+  std::vector<frame_id_t> all_victims;
+  for (auto &thread_victims : victims) {
+    all_victims.insert(all_victims.end(), thread_victims.begin(), thread_victims.end());
+  }
+  std::sort(all_victims.begin(), all_victims.end());
+  ASSERT_EQ(num_frames, all_victims.size());
+  for (size_t i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(static_cast<frame_id_t>(i), all_victims[i]);
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::CLOCK);
+
+  // Scenario: fill the pool, then keep creating pages. Unpinned pages are evicted and written back.
+  page_id_t page_id;
+  for (int i = 0; i < 10; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id = 0; page_id < 10; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "buffer/compressed_page_cache.h"
+#include "buffer/page_codec.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(CompressedPageCacheTest, CodecTest) {
+  char page[PAGE_SIZE];
+  char compressed[PAGE_SIZE + 64];
+  char decompressed[PAGE_SIZE];
+
+  // Scenario: an empty page shrinks to a handful of bytes and comes back unchanged.
+  memset(page, 0, PAGE_SIZE);
+  size_t size = PageCodec::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE);
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, 32);
+  ASSERT_EQ(PAGE_SIZE, PageCodec::Decompress(compressed, size, decompressed, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+
+  // Scenario: records with repeated fields round-trip, including literal and match lengths beyond 15.
+  for (int i = 0; i < PAGE_SIZE / 64; ++i) {
+    snprintf(page + i * 64, 64, "%08d|customer-%04d|Pittsburgh, PA|%s", i, i % 37, std::string(i % 20, 'x').c_str());
+  }
+  size = PageCodec::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE);
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, PAGE_SIZE / 2);
+  ASSERT_EQ(PAGE_SIZE, PageCodec::Decompress(compressed, size, decompressed, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+
+  // Scenario: random data does not fit in less than a page, and truncated input is rejected.
+  std::mt19937 rng(0);
+  for (char &byte : page) {
+    byte = static_cast<char>(rng());
+  }
+  EXPECT_EQ(0, PageCodec::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE - 1));
+  size = PageCodec::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE + 64);
+  ASSERT_NE(0, size);
+  ASSERT_EQ(PAGE_SIZE, PageCodec::Decompress(compressed, size, decompressed, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+  EXPECT_EQ(0, PageCodec::Decompress(compressed, size, decompressed, PAGE_SIZE - 1));
+}
+
+TEST(CompressedPageCacheTest, SampleTest) {
+  CompressedPageCache cache(PAGE_SIZE * 2);
+  char page[PAGE_SIZE];
+  char data[PAGE_SIZE];
+
+  // Scenario: a page that was put can be taken once, and comes back unchanged.
+  memset(page, 0, PAGE_SIZE);
+  snprintf(page, PAGE_SIZE, "page-1");
+  cache.Put(1, page);
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_LT(cache.GetSize(), PAGE_SIZE / 16);
+  ASSERT_TRUE(cache.Take(1, data));
+  EXPECT_EQ(0, memcmp(page, data, PAGE_SIZE));
+  EXPECT_FALSE(cache.Take(1, data));
+  EXPECT_EQ(0, cache.GetSize());
+
+  // Scenario: putting a page again replaces the older copy, and erased pages are gone.
+  cache.Put(2, page);
+  snprintf(page, PAGE_SIZE, "page-2");
+  cache.Put(2, page);
+  EXPECT_EQ(1, cache.GetNumPages());
+  ASSERT_TRUE(cache.Take(2, data));
+  EXPECT_EQ("page-2", std::string(data));
+  cache.Put(3, page);
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Take(3, data));
+
+  // Scenario: pages that do not compress are kept as they are, and the least recently put page makes room.
+  std::mt19937 rng(0);
+  for (page_id_t page_id = 10; page_id < 13; ++page_id) {
+    for (char &byte : page) {
+      byte = static_cast<char>(rng());
+    }
+    cache.Put(page_id, page);
+  }
+  EXPECT_EQ(2, cache.GetNumPages());
+  EXPECT_EQ(PAGE_SIZE * 2, cache.GetSize());
+  EXPECT_FALSE(cache.Take(10, data));
+  ASSERT_TRUE(cache.Take(12, data));
+  EXPECT_EQ(0, memcmp(page, data, PAGE_SIZE));
+
+  // Scenario: shrinking the capacity drops pages.
+  cache.SetCapacity(0);
+  EXPECT_EQ(0, cache.GetNumPages());
+
+  CompressedCacheStats stats = cache.GetStats();
+  EXPECT_EQ(7, stats.num_puts_);
+  EXPECT_EQ(6, stats.num_lookups_);
+  EXPECT_EQ(3, stats.num_hits_);
+  EXPECT_DOUBLE_EQ(0.5, stats.GetHitRate());
+  EXPECT_GT(stats.GetCompressionRatio(), 1);
+}
+
+}  // namespace bustub
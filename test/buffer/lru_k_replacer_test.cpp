@@ -0,0 +1,263 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: access frames 1-6 once and frame 1 a second time, then unpin them all.
+  for (frame_id_t frame_id : {1, 2, 3, 4, 5, 6, 1}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // Scenario: frames 2-6 have +inf backward 2-distance and go first, oldest access first. Frame 1 goes last.
+  int value;
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  // Scenario: pinned frames are not evicted. Pinning a victimized frame has no effect.
+  lru_replacer.Pin(4);
+  lru_replacer.Pin(5);
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // Scenario: frame 5 gets a second access, so now it has a finite distance younger than frame 1's.
+  lru_replacer.RecordAccess(5);
+  lru_replacer.Unpin(5);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_replacer.Size());
+
+  // Scenario: a removed frame loses its history.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.Remove(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, PeekVictimsTest) {
+  LRUKReplacer lru_replacer(5, 2);
+
+  for (frame_id_t frame_id : {0, 1, 2, 0, 3, 3}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+    lru_replacer.Unpin(frame_id);
+  }
+
+  // Scenario: frames with +inf backward 2-distance come first, then frame 0 before frame 3. Nothing is evicted.
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 0}), lru_replacer.PeekVictims(3));
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 0, 3}), lru_replacer.PeekVictims(10));
+  EXPECT_EQ(4, lru_replacer.Size());
+  int value;
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedWindowTest) {
+  LRUKReplacer lru_replacer(3, 2, 3);
+
+  // Scenario: accesses less than 3 ticks after the previous one are correlated and do not add to the history, so
+  // frames 0-2 all still have a single reference and +inf backward 2-distance.
+  for (frame_id_t frame_id : {0, 0, 1, 2, 1, 2}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 3; ++frame_id) {
+    lru_replacer.Unpin(frame_id);
+  }
+
+  // Frames 1 and 2 are still inside their correlated window, so frame 0 goes first.
+  int value;
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  // Once nothing else is left, frames inside the window are evicted in the usual order.
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  // Scenario: page 0 is fetched twice, pages 1 and 2 once. A new page evicts page 1 and keeps page 0.
+  page_id_t page_id;
+  for (int i = 0; i < 3; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(3, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  // Page 1 was written back when it was evicted.
+  auto *page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page-1"));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  // Scenario: a deleted page gives its frame back with no history.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, BufferPoolCorrelatedWindowTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K, 0, 4);
+
+  // Scenario: fetching page 0 right after creating pages 0-2 is correlated with its creation, so page 0 keeps a single
+  // reference and is evicted first, unlike without a window.
+  page_id_t page_id;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  uint64_t num_misses = bpm->GetNumMisses();
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(num_misses, bpm->GetNumMisses());
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(num_misses + 1, bpm->GetNumMisses());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Replays a page trace against num_frames frames the way BufferPoolManagerInstance drives its replacer: a hit pins
+ * the frame, every access is recorded, and the page is unpinned right after. Returns the hit ratio.
+ */
+double ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(num_frames, INVALID_PAGE_ID);
+  size_t next_free_frame = 0;
+  size_t hits = 0;
+
+  for (auto page_id : trace) {
+    frame_id_t frame_id;
+    auto iter = page_table.find(page_id);
+    if (iter != page_table.end()) {
+      frame_id = iter->second;
+      replacer->Pin(frame_id);
+      ++hits;
+    } else {
+      if (next_free_frame < num_frames) {
+        frame_id = static_cast<frame_id_t>(next_free_frame++);
+      } else {
+        EXPECT_TRUE(replacer->Victim(&frame_id));
+        page_table.erase(frame_pages[frame_id]);
+      }
+      page_table[page_id] = frame_id;
+      frame_pages[frame_id] = page_id;
+    }
+    replacer->RecordAccess(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return static_cast<double>(hits) / trace.size();
+}
+
+TEST(LRUKReplacerTest, ScanResistanceHitRatioTest) {
+  const size_t num_frames = 64;
+  const page_id_t num_index_pages = 48;
+  const page_id_t num_heap_pages = 10000;
+
+  // Point lookups on a set of index pages that fits in the pool, interleaved with a sequential scan over heap pages
+  // that are each touched once.
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<page_id_t> index_dist(0, num_index_pages - 1);
+  std::vector<page_id_t> trace;
+  page_id_t next_heap_page = num_index_pages;
+  for (int round = 0; round < 500; ++round) {
+    for (int i = 0; i < 20; ++i) {
+      trace.push_back(index_dist(rng));
+    }
+    for (int i = 0; i < 40; ++i) {
+      trace.push_back(next_heap_page++);
+      if (next_heap_page == num_index_pages + num_heap_pages) {
+        next_heap_page = num_index_pages;
+      }
+    }
+  }
+
+  LRUReplacer lru_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames, 2);
+  double lru_hit_ratio = ReplayTrace(&lru_replacer, num_frames, trace);
+  double lru_k_hit_ratio = ReplayTrace(&lru_k_replacer, num_frames, trace);
+  std::cout << "scan + point lookup trace of " << trace.size() << " accesses: LRU hit ratio " << lru_hit_ratio
+            << ", LRU-2 hit ratio " << lru_k_hit_ratio << std::endl;
+
+  // The scan can at best miss on every heap page, so 1/3 is the ceiling. LRU-2 keeps the index pages resident.
+  EXPECT_GT(lru_k_hit_ratio, 0.3);
+  EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+}
+
+}  // namespace bustub
@@ -59,4 +59,22 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(LRUReplacerTest, PeekVictimsTest) {
+  LRUReplacer lru_replacer(7);
+
+  for (frame_id_t frame_id : {1, 2, 3, 4}) {
+    lru_replacer.Unpin(frame_id);
+  }
+  lru_replacer.Pin(2);
+
+  // Scenario: peeking lists the next victims in order and leaves them in the replacer.
+  EXPECT_EQ((std::vector<frame_id_t>{1, 3}), lru_replacer.PeekVictims(2));
+  EXPECT_EQ((std::vector<frame_id_t>{1, 3, 4}), lru_replacer.PeekVictims(10));
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
 }  // namespace bustub
@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class MmapBufferPoolManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { remove("test.db"); }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, FetchTest) {
+  const int num_pages = 8;
+  DiskManager disk_manager("test.db");
+  {
+    BufferPoolManagerInstance bpm(4, &disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      Page *page = bpm.NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+    }
+    bpm.FlushAllPages();
+  }
+
+  MmapBufferPoolManager bpm(&disk_manager);
+  EXPECT_EQ(num_pages, bpm.GetPoolSize());
+
+  // Scenario: every page of the file can be pinned at once, and the pages are views of the file without a copy.
+  std::vector<Page *> pages;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(std::string("page-") + std::to_string(page_id), page->GetData());
+    pages.push_back(page);
+  }
+  EXPECT_EQ(pages[0]->GetData() + (num_pages - 1) * PAGE_SIZE, pages[num_pages - 1]->GetData());
+  EXPECT_EQ(pages[3], bpm.FetchPage(3));
+  EXPECT_EQ(2, pages[3]->GetPinCount());
+  EXPECT_EQ(nullptr, bpm.FetchPage(num_pages));
+  bpm.PrefetchPages({0, 1, num_pages});
+
+  // Scenario: writes are rejected.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+  EXPECT_EQ(false, bpm.DeletePage(0));
+  EXPECT_EQ(false, bpm.UnpinPage(3, true));
+  EXPECT_EQ(1, pages[3]->GetPinCount());
+  EXPECT_EQ(false, bpm.Resize(num_pages * 2));
+
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(false, bpm.UnpinPage(0, false));
+  EXPECT_EQ(true, bpm.FlushPage(0));
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, EmptyFileTest) {
+  DiskManager disk_manager("test.db");
+  MmapBufferPoolManager bpm(&disk_manager);
+  EXPECT_EQ(0, bpm.GetPoolSize());
+  EXPECT_EQ(nullptr, bpm.FetchPage(0));
+  disk_manager.ShutDown();
+}
+
+/**
+ * Writes a table of num_tuples tuples of about 100 bytes with a buffer pool and returns its first page. The pages are
+ * filled one after the other, as TableHeap::InsertTuple searches the table from its first page for every tuple.
+ */
+static page_id_t WriteTable(DiskManager *disk_manager, int num_tuples, Schema *schema) {
+  Transaction txn(0);
+  BufferPoolManagerInstance bpm(64, disk_manager);
+  TableHeap table(&bpm, nullptr, nullptr, &txn);
+  page_id_t page_id = table.GetFirstPageId();
+  auto *page = static_cast<TablePage *>(bpm.FetchPage(page_id));
+  std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(92, 'x')), ValueFactory::GetIntegerValue(0)};
+  for (int i = 0; i < num_tuples; ++i) {
+    values[1] = ValueFactory::GetIntegerValue(i);
+    Tuple tuple(values, schema);
+    RID rid;
+    if (!page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr)) {
+      page_id_t next_page_id;
+      auto *next_page = static_cast<TablePage *>(bpm.NewPageNear(&next_page_id, page_id, table.GetOwnerId()));
+      next_page->Init(next_page_id, PAGE_SIZE, page_id, nullptr, &txn);
+      page->SetNextPageId(next_page_id);
+      bpm.UnpinPage(page_id, true);
+      page_id = next_page_id;
+      page = next_page;
+      EXPECT_TRUE(page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr));
+    }
+  }
+  bpm.UnpinPage(page_id, true);
+  bpm.FlushAllPages();
+  return table.GetFirstPageId();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, TableScanTest) {
+  const int num_tuples = 2000;
+  Schema schema({Column("a", TypeId::VARCHAR, 92), Column("b", TypeId::INTEGER)});
+  DiskManager disk_manager("test.db");
+  page_id_t first_page_id = WriteTable(&disk_manager, num_tuples, &schema);
+
+  // Scenario: a table heap scans the file through the read-only buffer pool.
+  MmapBufferPoolManager bpm(&disk_manager);
+  Transaction txn(1);
+  TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+  int num_scanned = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+    EXPECT_EQ(num_scanned, it->GetValue(&schema, 1).GetAs<int32_t>());
+    ++num_scanned;
+  }
+  EXPECT_EQ(num_tuples, num_scanned);
+  disk_manager.ShutDown();
+}
+
+// Scans a table of about 64 MB, warm, and reports the scan bandwidth: with a buffer pool that holds all of it, both
+// through the ring of a sequential scan, which reads every page again, and with normal access, where every page is
+// resident, and with the read-only mapping. Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, DISABLED_ScanBenchmark) {
+  const int num_tuples = 500000;
+  const int num_rounds = 5;
+  Schema schema({Column("a", TypeId::VARCHAR, 92), Column("b", TypeId::INTEGER)});
+  DiskManager disk_manager("test.db");
+  page_id_t first_page_id = WriteTable(&disk_manager, num_tuples, &schema);
+  double table_mb = static_cast<double>(disk_manager.GetDbFileSize()) / (1 << 20);
+
+  auto scan = [&](BufferPoolManager *bpm, AccessType access_type, const char *name) {
+    Transaction txn(1);
+    TableHeap table(bpm, nullptr, nullptr, first_page_id);
+    int64_t sum = 0;
+    std::chrono::steady_clock::duration elapsed{};
+    for (int round = 0; round <= num_rounds; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      for (auto it = table.Begin(&txn, access_type); it != table.End(); ++it) {
+        sum += it->GetValue(&schema, 1).GetAs<int32_t>();
+      }
+      // The first round warms up the cache.
+      if (round > 0) {
+        elapsed += std::chrono::steady_clock::now() - start;
+      }
+    }
+    auto seconds = std::chrono::duration<double>(elapsed).count() / num_rounds;
+    std::cout << name << ": " << table_mb / seconds << " MB/s (" << sum << ")" << std::endl;
+  };
+
+  {
+    BufferPoolManagerInstance bpm(disk_manager.GetDbFileSize() / PAGE_SIZE + 16, &disk_manager);
+    scan(&bpm, AccessType::SequentialScan, "buffer pool, sequential scan");
+    scan(&bpm, AccessType::Normal, "buffer pool, normal access");
+  }
+  {
+    MmapBufferPoolManager bpm(&disk_manager);
+    scan(&bpm, AccessType::SequentialScan, "mmap");
+  }
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
@@ -16,18 +16,18 @@
 #include <unordered_map>
 
 #include "../test/buffer/counter.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 namespace bustub {
 
-// Add callback functions on BufferPoolManager
-class MockBufferPoolManager : public BufferPoolManager {
+// Add callback functions on BufferPoolManagerInstance
+class MockBufferPoolManager : public BufferPoolManagerInstance {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (MockBufferPoolManager::*)(enum CallbackType type, FuncType func_type);
 
   MockBufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr)
-      : BufferPoolManager(pool_size, disk_manager, log_manager) {}
+      : BufferPoolManagerInstance(pool_size, disk_manager, log_manager) {}
 
   void counter_callback(enum CallbackType type, FuncType func_type) {
     if (type == CallbackType::BEFORE) {
@@ -59,7 +59,7 @@ class MockBufferPoolManager : public BufferPoolManager {
   /** Grading function. Do not modify/call! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) {
     GradingCallback(callback, CallbackType::BEFORE, FuncType::FetchPage, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, AccessType::Normal);
     GradingCallback(callback, CallbackType::AFTER, FuncType::FetchPage, page_id);
     return result;
   }
@@ -122,11 +122,12 @@ class MockBufferPoolManager : public BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id) {
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) {
     counter.AddCount(FuncType::FetchPage);
-    return BufferPoolManager::FetchPageImpl(page_id);
+    return BufferPoolManagerInstance::FetchPageImpl(page_id, access_type);
   }
 
   /**
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+
+  // Scenario: an empty table finds nothing.
+  frame_id_t frame_id;
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  EXPECT_EQ(0, page_table.Size());
+
+  // Scenario: inserted pages are found with their frames.
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    page_table.Insert(page_id, 3 - page_id);
+  }
+  EXPECT_EQ(4, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(3 - page_id, frame_id);
+  }
+
+  // Scenario: an erased page is gone and its slot can be reused.
+  EXPECT_TRUE(page_table.Erase(2));
+  EXPECT_FALSE(page_table.Erase(2));
+  EXPECT_FALSE(page_table.Contains(2));
+  page_table.Insert(100, 1);
+  ASSERT_TRUE(page_table.Find(100, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_EQ(4, page_table.Size());
+}
+
+TEST(PageTableTest, OverflowTest) {
+  const size_t capacity = 64;
+  PageTable page_table(capacity);
+
+  // Page ids that are a large power of two apart tend to share buckets, so probing crosses bucket boundaries.
+  for (size_t round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < capacity; ++i) {
+      page_table.Insert(static_cast<page_id_t>((round * capacity + i) << 12), static_cast<frame_id_t>(i));
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(page_table.Find(static_cast<page_id_t>((round * capacity + i) << 12), &frame_id));
+      EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+      EXPECT_TRUE(page_table.Erase(static_cast<page_id_t>((round * capacity + i) << 12)));
+    }
+    EXPECT_EQ(0, page_table.Size());
+  }
+}
+
+TEST(PageTableTest, ConcurrentReadersTest) {
+  const size_t capacity = 128;
+  PageTable page_table(capacity);
+
+  // Even pages stay in the table, odd pages come and go while the readers run.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(capacity); page_id += 2) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(capacity); ++page_id) {
+          frame_id_t frame_id;
+          bool found = page_table.Find(page_id, &frame_id);
+          if (page_id % 2 == 0) {
+            ASSERT_TRUE(found);
+          }
+          if (found) {
+            EXPECT_EQ(page_id, frame_id);
+          }
+        }
+      }
+    });
+  }
+
+  for (int round = 0; round < 1000; ++round) {
+    for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(capacity); page_id += 2) {
+      page_table.Insert(page_id, page_id);
+    }
+    for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(capacity); page_id += 2) {
+      page_table.Erase(page_id);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(capacity / 2, page_table.Size());
+}
+
+}  // namespace bustub
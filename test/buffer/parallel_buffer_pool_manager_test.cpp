@@ -0,0 +1,414 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_slow.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: Page ids are handed out in order and spread evenly, so we can fill every instance.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+
+  // Scenario: Unpinning page 0 frees a frame in its instance, so it can be evicted and fetched back.
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(false, bpm->UnpinPage(0, true));
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: A pinned page cannot be deleted, an unpinned one can.
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  bpm->FlushAllPages();
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 25;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 10, disk_manager);
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::vector<page_id_t> page_ids;
+      for (size_t i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%zu-%d", tid, page_id);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        page_ids.push_back(page_id);
+      }
+      for (auto page_id : page_ids) {
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(tid) + "-" + std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Pages 0-15 end up on disk, pages 16-31 are resident.
+  for (size_t i = 0; i < 2 * buffer_pool_size * num_instances; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: every page is prefetched by the instance that owns it.
+  bpm->PrefetchPages({0, 1, 2, 3});
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: neighbouring pages live in different instances, but are still written together.
+  int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 1, disk_manager->GetNumWrites());
+
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(data));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesConcurrencyTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  DiskManagerMemory memory;
+  SlowDiskOptions options;
+  options.sync_latency_ = std::chrono::milliseconds(200);
+  DiskManagerSlow disk_manager(&memory, options);
+  ParallelBufferPoolManager bpm(num_instances, buffer_pool_size, &disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < num_instances; ++i) {
+    auto *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+
+  // Scenario: the latches are released while the pages are written, so other pages can be created meanwhile, and
+  // changes made during the write are not lost.
+  std::atomic<bool> flushed{false};
+  std::thread flusher([&] {
+    bpm.FlushAllPages();
+    flushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  auto *page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page-0-changed");
+  EXPECT_EQ(true, bpm.UnpinPage(0, true));
+  EXPECT_FALSE(flushed);
+  flusher.join();
+
+  bpm.FlushAllPages();
+  char data[PAGE_SIZE];
+  memory.ReadPage(0, data);
+  EXPECT_EQ(std::string("page-0-changed"), data);
+  memory.ReadPage(1, data);
+  EXPECT_EQ(std::string("page-1"), data);
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StalePageTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  DiskManagerMemory disk_manager;
+  ParallelBufferPoolManager bpm(num_instances, buffer_pool_size, &disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+
+  // Scenario: a deleted page is fetched again under its stale id and stays pinned. NewPage does not give up on the
+  // lowest free id, but takes the next one every time.
+  EXPECT_EQ(true, bpm.DeletePage(1));
+  ASSERT_NE(nullptr, bpm.FetchPage(1));
+  for (page_id_t expected : {4, 5}) {
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  // Scenario: once the copy is unpinned, it is dropped and the id is reused, in a single frame.
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+  auto *page = bpm.NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page_id);
+  EXPECT_EQ(page, bpm.FetchPage(1));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 8;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            max_pool_size);
+
+  // Scenario: the new size is spread over the instances, each of which has to stay within its bounds.
+  EXPECT_FALSE(bpm->Resize(max_pool_size * num_instances + 1));
+  EXPECT_FALSE(bpm->Resize(1));
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+  EXPECT_TRUE(bpm->Resize(max_pool_size * num_instances));
+  EXPECT_EQ(max_pool_size * num_instances, bpm->GetPoolSize());
+
+  // Scenario: every instance can now hold max_pool_size pages at once.
+  page_id_t page_id;
+  for (size_t i = 0; i < max_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_pool_size * num_instances); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  EXPECT_TRUE(bpm->Resize(3));
+  EXPECT_EQ(3, bpm->GetPoolSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const std::string warm_file_name = "test.warm";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Pages 8-15 end up resident.
+  for (size_t i = 0; i < 2 * buffer_pool_size * num_instances; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  bpm->SaveResidentPages(warm_file_name);
+  delete bpm;
+
+  // Scenario: every instance loads back the pages it owns.
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  bpm->WarmUp(warm_file_name);
+  bpm->WaitForWarmUp();
+  int num_reads = disk_manager->GetNumReads();
+  for (page_id_t page_id = 8; page_id < 16; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(warm_file_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Fetch throughput of a fully resident working set as the number of instances grows.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_FetchThroughputBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t total_frames = 256;
+  const size_t num_threads = std::max(2U, std::thread::hardware_concurrency());
+  const auto duration = std::chrono::seconds(1);
+
+  for (size_t num_instances : {1, 2, 4, 8, 16}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+
+    // Working set fits in the pool, so every fetch is a hit and the measurement is pure latch contention.
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < total_frames / 2; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      page_ids.push_back(page_id);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total_ops{0};
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+        uint64_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          page_id_t page_id = page_ids[dist(rng)];
+          if (bpm->FetchPage(page_id) != nullptr) {
+            bpm->UnpinPage(page_id, false);
+            ++ops;
+          }
+        }
+        total_ops += ops;
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::cout << "instances=" << num_instances << " threads=" << num_threads
+              << " fetches/sec=" << total_ops / duration.count() << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
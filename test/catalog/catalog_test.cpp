@@ -14,9 +14,12 @@
 #include <unordered_set>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_set.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -24,7 +27,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(CatalogTest, CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
-  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto bpm = new BufferPoolManagerInstance(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
   std::string table_name = "potato";
 
@@ -48,4 +51,58 @@ TEST(CatalogTest, CreateTableTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, BufferPoolTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto pools = new BufferPoolSet(disk_manager);
+  auto index_pool = pools->AddPool(BufferPoolSet::INDEX_POOL, 16);
+  auto heap_pool = pools->AddPool(BufferPoolSet::HEAP_POOL, 8);
+  auto catalog = new Catalog(nullptr, nullptr, nullptr, pools);
+
+  // B+trees keep their roots in the header page, which belongs to the index pool.
+  page_id_t header_page_id;
+  ASSERT_NE(nullptr, index_pool->NewPage(&header_page_id));
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  index_pool->UnpinPage(header_page_id, true);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::BOOLEAN);
+  Schema schema(columns);
+  EXPECT_THROW(catalog->CreateTable(nullptr, "potato", schema, BufferPoolSet::TEMP_POOL), std::out_of_range);
+
+  // Scenario: the pages of a table and of its index live in the pools they are bound to.
+  Transaction txn(0);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema, BufferPoolSet::HEAP_POOL);
+  EXPECT_EQ(BufferPoolSet::HEAP_POOL, table_metadata->pool_name_);
+  EXPECT_EQ(heap_pool, table_metadata->table_->GetBufferPoolManager());
+  for (int64_t i = 0; i < 1000; ++i) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetBooleanValue(i % 2 == 0)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::BIGINT);
+  Schema key_schema(key_columns);
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "potato_a", "potato", schema, key_schema, {0}, 8, BufferPoolSet::INDEX_POOL);
+  EXPECT_EQ(BufferPoolSet::INDEX_POOL, index_info->pool_name_);
+  uint64_t heap_misses = pools->GetStats(BufferPoolSet::HEAP_POOL).num_misses_;
+  for (int64_t i = 0; i < 1000; i += 7) {
+    std::vector<RID> rids;
+    Tuple key({ValueFactory::GetBigIntValue(i)}, &key_schema);
+    index_info->index_->ScanKey(key, &rids, &txn);
+    ASSERT_EQ(1, rids.size());
+  }
+  EXPECT_EQ(heap_misses, pools->GetStats(BufferPoolSet::HEAP_POOL).num_misses_);
+  EXPECT_EQ(0, pools->GetStats(BufferPoolSet::INDEX_POOL).num_misses_);
+
+  delete catalog;
+  delete pools;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -32,6 +32,7 @@ class RecoveryTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.warm");
   }
 
   // This function is called after every test.
@@ -39,6 +40,7 @@ class RecoveryTest : public ::testing::Test {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
     remove("test.log");
+    remove("test.warm");
   };
 };
 
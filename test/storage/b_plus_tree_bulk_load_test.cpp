@@ -0,0 +1,267 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using Sorter = ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+/**
+ * Checks the sizes and parent links of the subtree under page_id, and that its leaves are all at the same depth.
+ * @return the height of the subtree
+ */
+int CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_page_id, int leaf_max_size,
+                 int internal_max_size) {
+  auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(parent_page_id, page->GetParentPageId());
+  int height = 1;
+  if (page->IsLeafPage()) {
+    if (!page->IsRootPage()) {
+      EXPECT_GE(page->GetSize(), leaf_max_size / 2);
+    }
+    EXPECT_LT(page->GetSize(), leaf_max_size);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page);
+    EXPECT_GE(internal->GetSize(), page->IsRootPage() ? 2 : (internal_max_size + 1) / 2);
+    EXPECT_LE(internal->GetSize(), internal_max_size);
+    height += CheckSubtree(bpm, internal->ValueAt(0), page_id, leaf_max_size, internal_max_size);
+    for (int i = 1; i < internal->GetSize(); ++i) {
+      EXPECT_EQ(height, 1 + CheckSubtree(bpm, internal->ValueAt(i), page_id, leaf_max_size, internal_max_size));
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return height;
+}
+
+/** Checks the shape of the tree with the given name. */
+void CheckTree(BufferPoolManager *bpm, const std::string &name, int leaf_max_size, int internal_max_size) {
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t root_page_id;
+  ASSERT_TRUE(header_page->GetRootId(name, &root_page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  CheckSubtree(bpm, root_page_id, INVALID_PAGE_ID, leaf_max_size, internal_max_size);
+}
+
+TEST(BPlusTreeBulkLoadTests, SorterTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManagerMemory();
+  // Fewer frames than pages of runs, so that the runs are written out and read back.
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+
+  const int64_t num_keys = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  GenericKey<8> index_key;
+  {
+    // Scenario: every key is added twice across many runs, and only the pair added first is read back in order.
+    const size_t run_size = Sorter::PAIRS_PER_PAGE * 3 / 2;
+    Sorter sorter(bpm, comparator, run_size);
+    for (int round = 0; round < 2; ++round) {
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(round, key));
+      }
+    }
+    sorter.Sort();
+    EXPECT_EQ((2 * num_keys + run_size - 1) / run_size, sorter.GetNumRuns());
+
+    std::pair<GenericKey<8>, RID> pair;
+    int64_t expected = 0;
+    while (sorter.Next(&pair)) {
+      index_key.SetFromInteger(expected);
+      ASSERT_EQ(0, comparator(index_key, pair.first));
+      ASSERT_EQ(RID(0, expected), pair.second);
+      ++expected;
+    }
+    EXPECT_EQ(num_keys, expected);
+    EXPECT_EQ(num_keys, sorter.GetNumPairs());
+    // The pages of the runs were deleted as they were read.
+    EXPECT_GE(disk_manager->GetNumFreePages(), 2 * num_keys / Sorter::PAIRS_PER_PAGE);
+  }
+
+  {
+    // Scenario: a sorter that is dropped before it is read deletes its runs.
+    size_t num_free_pages = disk_manager->GetNumFreePages();
+    {
+      Sorter sorter(bpm, comparator, Sorter::PAIRS_PER_PAGE);
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(0, key));
+      }
+      sorter.Sort();
+      std::pair<GenericKey<8>, RID> pair;
+      ASSERT_TRUE(sorter.Next(&pair));
+    }
+    EXPECT_EQ(num_free_pages, disk_manager->GetNumFreePages());
+  }
+
+  {
+    // Scenario: pairs that fit in one run are sorted in memory.
+    Sorter sorter(bpm, comparator);
+    for (auto key : {3, 1, 2, 1}) {
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(0, key));
+    }
+    sorter.Sort();
+    EXPECT_EQ(0, sorter.GetNumRuns());
+    std::pair<GenericKey<8>, RID> pair;
+    for (int64_t key = 1; key <= 3; ++key) {
+      ASSERT_TRUE(sorter.Next(&pair));
+      EXPECT_EQ(RID(0, key), pair.second);
+    }
+    EXPECT_FALSE(sorter.Next(&pair));
+    EXPECT_EQ(3, sorter.GetNumPairs());
+  }
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoadTests, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManagerMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, true);
+
+  const int leaf_max_size = 4;
+  const int internal_max_size = 5;
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  Transaction transaction(0);
+  for (int64_t num_keys : {0, 1, 3, 4, 5, 17, 1000}) {
+    for (double fill_factor : {0.0, 0.5, 0.9, 1.0}) {
+      // Every tree keeps its root in a record of its own in the header page.
+      std::string name = "foo_pk_" + std::to_string(num_keys) + "_" + std::to_string(fill_factor);
+      Tree tree(name, bpm, comparator, leaf_max_size, internal_max_size);
+      Sorter sorter(bpm, comparator, 64);
+      for (int64_t key = num_keys - 1; key >= 0; --key) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(0, key));
+      }
+      sorter.Sort();
+      ASSERT_TRUE(tree.BulkLoad(&sorter, fill_factor));
+      ASSERT_EQ(num_keys == 0, tree.IsEmpty());
+      if (num_keys == 0) {
+        continue;
+      }
+      CheckTree(bpm, name, leaf_max_size, internal_max_size);
+
+      // Scenario: the loaded tree finds every key and scans them in order.
+      int64_t expected = 0;
+      for (auto it = tree.Begin(); it != tree.End(); ++it) {
+        ASSERT_EQ(RID(0, expected), (*it).second);
+        ++expected;
+      }
+      ASSERT_EQ(num_keys, expected);
+      for (int64_t key = 0; key < num_keys; ++key) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(RID(0, key), rids[0]);
+      }
+
+      // Scenario: a tree that is not empty is not loaded again.
+      Sorter other_sorter(bpm, comparator);
+      other_sorter.Sort();
+      EXPECT_FALSE(tree.BulkLoad(&other_sorter, fill_factor));
+
+      // Scenario: the loaded tree splits and merges like one built by inserts.
+      for (int64_t key = num_keys; key < 2 * num_keys; ++key) {
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree.Insert(index_key, RID(0, key), &transaction));
+      }
+      for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, &transaction);
+      }
+      CheckTree(bpm, name, leaf_max_size, internal_max_size);
+      for (int64_t key = 0; key < 2 * num_keys; ++key) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        ASSERT_EQ(key % 2 == 1, tree.GetValue(index_key, &rids));
+      }
+      for (int64_t key = 1; key < 2 * num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, &transaction);
+      }
+      ASSERT_TRUE(tree.IsEmpty());
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoadTests, DISABLED_BulkLoadBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1 << 20;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  GenericKey<8> index_key;
+  for (bool bulk_load : {false, true}) {
+    auto *disk_manager = new DiskManagerMemory();
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(16384, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, true);
+    Tree tree("foo_pk", bpm, comparator);
+    Transaction transaction(0);
+
+    auto start = std::chrono::steady_clock::now();
+    if (bulk_load) {
+      Sorter sorter(bpm, comparator);
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(0, key));
+      }
+      sorter.Sort();
+      tree.BulkLoad(&sorter);
+    } else {
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key), &transaction);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (bulk_load ? "bulk load" : "inserts") << ": " << num_keys / elapsed.count() << " keys/s" << std::endl;
+
+    delete bpm;
+    delete disk_manager;
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,297 @@
+/**
+ * b_plus_tree_compression_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "storage/page/header_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+using Sorter = ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+/** Max sizes of plain pages, which compressed pages ignore. An internal page overflows into one more slot. */
+const int LEAF_MAX_SIZE = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<64>, RID>);
+const int INTERNAL_MAX_SIZE =
+    (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<64>, page_id_t>) - 1;
+
+/** The shape of a tree. */
+struct TreeShape {
+  int height_;
+  size_t num_pages_;
+};
+
+/**
+ * Checks the format and parent links of the pages under page_id, that none of them is left full, and that its leaves
+ * are all at the same depth.
+ */
+TreeShape CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_page_id, bool is_compressed) {
+  auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(parent_page_id, page->GetParentPageId());
+  EXPECT_EQ(is_compressed, page->IsCompressed());
+  TreeShape shape{1, 1};
+  if (page->IsLeafPage()) {
+    EXPECT_FALSE(reinterpret_cast<LeafPage *>(page)->IsFull());
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page);
+    EXPECT_FALSE(internal->IsFull());
+    for (int i = 0; i < internal->GetSize(); ++i) {
+      TreeShape child = CheckSubtree(bpm, internal->ValueAt(i), page_id, is_compressed);
+      if (i == 0) {
+        shape.height_ += child.height_;
+      }
+      EXPECT_EQ(shape.height_, 1 + child.height_);
+      shape.num_pages_ += child.num_pages_;
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return shape;
+}
+
+/** Checks the tree with the given name. @return its shape */
+TreeShape CheckTree(BufferPoolManager *bpm, const std::string &name, bool is_compressed) {
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t root_page_id;
+  EXPECT_TRUE(header_page->GetRootId(name, &root_page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  return CheckSubtree(bpm, root_page_id, INVALID_PAGE_ID, is_compressed);
+}
+
+/** @return the key of a tuple with one varchar column */
+GenericKey<64> StringKey(const std::string &str, Schema *key_schema) {
+  GenericKey<64> index_key;
+  index_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(str)}, key_schema));
+  return index_key;
+}
+
+TEST(BPlusTreeCompressionTests, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+  auto *disk_manager = new DiskManagerMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, true);
+
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  GenericKey<64> index_key;
+  std::vector<RID> rids;
+  Transaction transaction(0);
+  TreeShape shapes[2];
+  for (bool compress_keys : {false, true}) {
+    std::string name = compress_keys ? "compressed_pk" : "plain_pk";
+    Tree tree(name, bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, compress_keys);
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, RID(0, key), &transaction));
+    }
+    index_key.SetFromInteger(keys[0]);
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, 0), &transaction));
+    shapes[compress_keys] = CheckTree(bpm, name, compress_keys);
+
+    // Scenario: compressed pages read back the same keys and values, in the same order.
+    int64_t expected = 0;
+    for (auto it = tree.Begin(); it != tree.End(); ++it) {
+      ASSERT_EQ(expected, (*it).first.ToString());
+      ASSERT_EQ(RID(0, expected), (*it).second);
+      ++expected;
+    }
+    ASSERT_EQ(num_keys, expected);
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      ASSERT_EQ(RID(0, key), rids[0]);
+    }
+
+    // Scenario: pages that underflow by bytes merge or borrow from their neighbors.
+    for (size_t i = 0; i < keys.size() * 3 / 4; ++i) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key, &transaction);
+    }
+    CheckTree(bpm, name, compress_keys);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      rids.clear();
+      index_key.SetFromInteger(keys[i]);
+      ASSERT_EQ(i >= keys.size() * 3 / 4, tree.GetValue(index_key, &rids));
+    }
+    for (size_t i = keys.size() * 3 / 4; i < keys.size(); ++i) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key, &transaction);
+    }
+    ASSERT_TRUE(tree.IsEmpty());
+  }
+
+  // Small integers in a 64 byte key are mostly zero bytes, which compressed pages do not store.
+  EXPECT_LT(shapes[1].num_pages_ * 3, shapes[0].num_pages_);
+  EXPECT_LT(shapes[1].height_, shapes[0].height_);
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+}
+
+TEST(BPlusTreeCompressionTests, StringKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(40)");
+  GenericComparator<64> comparator(key_schema);
+  auto *disk_manager = new DiskManagerMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, true);
+
+  // Keys share a long prefix, and differ early enough after it that separators can be cut short.
+  const int64_t num_keys = 10000;
+  std::vector<std::string> strings;
+  for (int64_t i = 0; i < num_keys; ++i) {
+    strings.push_back("customer/" + std::to_string(i * 2654435761 % 1000003) + "/orders");
+  }
+  std::vector<std::string> sorted = strings;
+  std::sort(sorted.begin(), sorted.end());
+
+  std::vector<RID> rids;
+  Transaction transaction(0);
+  for (bool bulk_load : {false, true}) {
+    std::string name = bulk_load ? "bulk_loaded_pk" : "inserted_pk";
+    Tree tree(name, bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, true);
+    if (bulk_load) {
+      Sorter sorter(bpm, comparator, 1024);
+      for (int64_t i = 0; i < num_keys; ++i) {
+        sorter.Add(StringKey(strings[i], key_schema), RID(0, i));
+      }
+      sorter.Sort();
+      ASSERT_TRUE(tree.BulkLoad(&sorter));
+    } else {
+      for (int64_t i = 0; i < num_keys; ++i) {
+        ASSERT_TRUE(tree.Insert(StringKey(strings[i], key_schema), RID(0, i), &transaction));
+      }
+    }
+    TreeShape shape = CheckTree(bpm, name, true);
+    EXPECT_LE(shape.height_, 2);
+
+    // Scenario: lookups find every key through the separators that were cut short.
+    for (int64_t i = 0; i < num_keys; ++i) {
+      rids.clear();
+      ASSERT_TRUE(tree.GetValue(StringKey(strings[i], key_schema), &rids));
+      ASSERT_EQ(RID(0, i), rids[0]);
+    }
+    rids.clear();
+    EXPECT_FALSE(tree.GetValue(StringKey("customer/", key_schema), &rids));
+    EXPECT_FALSE(tree.GetValue(StringKey("customer/1", key_schema), &rids));
+    size_t position = 0;
+    for (auto it = tree.Begin(); it != tree.End(); ++it) {
+      ASSERT_EQ(0, comparator(StringKey(sorted[position], key_schema), (*it).first));
+      ++position;
+    }
+    ASSERT_EQ(sorted.size(), position);
+
+    // Scenario: separators that are cut short keep routing keys after removes.
+    for (int64_t i = 0; i < num_keys; i += 2) {
+      tree.Remove(StringKey(strings[i], key_schema), &transaction);
+    }
+    CheckTree(bpm, name, true);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      rids.clear();
+      ASSERT_EQ(i % 2 == 1, tree.GetValue(StringKey(strings[i], key_schema), &rids));
+    }
+    for (int64_t i = 1; i < num_keys; i += 2) {
+      tree.Remove(StringKey(strings[i], key_schema), &transaction);
+    }
+    ASSERT_TRUE(tree.IsEmpty());
+  }
+
+  // Scenario: bulk loads fill nodes by bytes, at any fill factor and for any number of keys.
+  for (int64_t num_keys_loaded : {int64_t{1}, num_keys}) {
+    for (double fill_factor : {0.0, 1.0}) {
+      std::string name = "bulk_loaded_pk_" + std::to_string(num_keys_loaded) + "_" + std::to_string(fill_factor);
+      Tree tree(name, bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, true);
+      Sorter sorter(bpm, comparator, 1024);
+      for (int64_t i = 0; i < num_keys_loaded; ++i) {
+        sorter.Add(StringKey(strings[i], key_schema), RID(0, i));
+      }
+      sorter.Sort();
+      ASSERT_TRUE(tree.BulkLoad(&sorter, fill_factor));
+      TreeShape shape = CheckTree(bpm, name, true);
+      EXPECT_EQ(num_keys_loaded == 1 ? 1 : 2, shape.height_);
+      int64_t num_read = 0;
+      for (auto it = tree.Begin(); it != tree.End(); ++it) {
+        ++num_read;
+      }
+      EXPECT_EQ(num_keys_loaded, num_read);
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+}
+
+TEST(BPlusTreeCompressionTests, DISABLED_CompressionBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+  const int64_t num_keys = 1 << 20;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  GenericKey<64> index_key;
+  std::vector<RID> rids;
+  for (bool compress_keys : {false, true}) {
+    auto *disk_manager = new DiskManagerMemory();
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(65536, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, true);
+    Tree tree("foo_pk", bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, compress_keys);
+    Transaction transaction(0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+    }
+    std::chrono::duration<double> lookup_time = std::chrono::steady_clock::now() - start;
+
+    TreeShape shape = CheckTree(bpm, "foo_pk", compress_keys);
+    std::cout << (compress_keys ? "compressed" : "plain") << ": " << shape.num_pages_ << " pages, height "
+              << shape.height_ << ", " << num_keys / insert_time.count() << " inserts/s, "
+              << num_keys / lookup_time.count() << " lookups/s" << std::endl;
+
+    delete bpm;
+    delete disk_manager;
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
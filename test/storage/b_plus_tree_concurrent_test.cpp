@@ -2,14 +2,19 @@
  * b_plus_tree_test.cpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
+#include <random>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 
 namespace bustub {
@@ -98,7 +103,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -150,7 +155,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -203,7 +208,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -246,7 +251,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -290,7 +295,7 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -330,4 +335,174 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, MixSplitMergeTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManagerMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that most inserts and removes split or merge and take the pessimistic path
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // first, populate index with the keys that are removed
+  const int64_t scale_factor = 2000;
+  const int num_threads = 4;
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> insert_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    (key % 2 == 0 ? remove_keys : insert_keys).push_back(key);
+  }
+  std::shuffle(remove_keys.begin(), remove_keys.end(), std::mt19937(0));
+  std::shuffle(insert_keys.begin(), insert_keys.end(), std::mt19937(1));
+  InsertHelper(&tree, remove_keys);
+
+  // remove the even keys while the odd keys are inserted
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(InsertHelperSplit, &tree, insert_keys, num_threads, i);
+    threads.emplace_back(DeleteHelperSplit, &tree, remove_keys, num_threads, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 1, tree.GetValue(index_key, &rids)) << key;
+  }
+  int64_t size = 0;
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+    size = size + 1;
+  }
+  EXPECT_EQ(scale_factor / 2, size);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BPlusTreeConcurrentTest, RootChangeTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManagerMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that the root splits and merges every few keys
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  EXPECT_TRUE(tree.Begin() == tree.End());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+
+  // writers grow the tree from empty and shrink it back to empty, while readers look up keys
+  const int num_rounds = 200;
+  const int num_writers = 2;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&tree, &done] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      while (!done) {
+        for (int64_t key = 0; key < 8; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (tree.GetValue(index_key, &rids)) {
+            EXPECT_EQ(key, rids[0].GetSlotNum());
+          }
+        }
+      }
+    });
+  }
+  std::vector<int64_t> keys = {0, 1, 2, 3, 4, 5, 6, 7};
+  for (int round = 0; round < num_rounds; round++) {
+    LaunchParallelTest(num_writers, InsertHelperSplit, &tree, keys, num_writers);
+    LaunchParallelTest(num_writers, DeleteHelperSplit, &tree, keys, num_writers);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  InsertHelper(&tree, keys);
+  int64_t size = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.end(); ++iterator) {
+    size = size + 1;
+  }
+  EXPECT_EQ(8, size);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+}
+
+// Inserts, lookups and removes per second with 1 to 64 threads working on disjoint keys of one tree.
+// Run with --gtest_also_run_disabled_tests.
+TEST(BPlusTreeConcurrentTest, DISABLED_ThroughputBenchmark) {
+  const int64_t num_keys = 1 << 18;
+
+  for (uint64_t num_threads = 1; num_threads <= 64; num_threads *= 2) {
+    Schema *key_schema = ParseCreateStatement("a bigint");
+    GenericComparator<8> comparator(key_schema);
+    DiskManager *disk_manager = new DiskManagerMemory();
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(16384, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    std::vector<int64_t> keys(num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      keys[key] = key;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+    auto run = [&](const std::function<void(uint64_t)> &body) {
+      auto start = std::chrono::steady_clock::now();
+      LaunchParallelTest(num_threads, body);
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      return num_keys * 1000 / std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    };
+    auto inserts = run([&](uint64_t thread_itr) { InsertHelperSplit(&tree, keys, num_threads, thread_itr); });
+    auto lookups = run([&](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (auto key : keys) {
+        if (static_cast<uint64_t>(key) % num_threads == thread_itr) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          tree.GetValue(index_key, &rids);
+        }
+      }
+    });
+    auto removes = run([&](uint64_t thread_itr) { DeleteHelperSplit(&tree, keys, num_threads, thread_itr); });
+    std::cout << "threads=" << num_threads << " inserts/sec=" << inserts << " lookups/sec=" << lookups
+              << " removes/sec=" << removes << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
 }  // namespace bustub
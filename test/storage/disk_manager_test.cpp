@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_slow.h"
 
 namespace bustub {
 
@@ -55,6 +65,305 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WriteReadPagesTest) {
+  const int num_pages = 8;
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<char> buf((num_pages + 1) * PAGE_SIZE);
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Pages 0-2 and 5-7, out of order. Consecutive ids are written together, so that takes two writes.
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (page_id_t page_id : {6, 1, 0, 7, 5, 2}) {
+    snprintf(data[page_id].data(), PAGE_SIZE, "page-%d", page_id);
+    pages.emplace_back(page_id, data[page_id].data());
+  }
+  int num_writes = dm.GetNumWrites();
+  dm.WritePages(pages);
+  EXPECT_EQ(num_writes + 2, dm.GetNumWrites());
+
+  // Read them back with a single read, which includes the gap and zeros past the end of the file.
+  int num_reads = dm.GetNumReads();
+  dm.ReadPages(0, num_pages + 1, buf.data());
+  EXPECT_EQ(num_reads + 1, dm.GetNumReads());
+  for (page_id_t page_id : {0, 1, 2, 5, 6, 7}) {
+    EXPECT_EQ(0, std::memcmp(buf.data() + page_id * PAGE_SIZE, data[page_id].data(), PAGE_SIZE));
+  }
+  EXPECT_EQ(0, buf[num_pages * PAGE_SIZE]);
+
+  // The stream sees what was written.
+  dm.ReadPage(6, buf.data());
+  EXPECT_EQ(0, std::memcmp(buf.data(), data[6].data(), PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 4;
+  const int num_rounds = 200;
+  DiskManager dm("test.db");
+
+  // Scenario: a page past the end of the file reads as zeros, and the file size is known without asking the file.
+  std::vector<char> buf(PAGE_SIZE, 'x');
+  dm.ReadPage(3, buf.data());
+  EXPECT_TRUE(std::all_of(buf.begin(), buf.end(), [](char c) { return c == 0; }));
+  EXPECT_EQ(0, dm.GetDbFileSize());
+
+  // Scenario: every thread writes and reads back its own pages while the others do the same.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::vector<char> data(PAGE_SIZE);
+      std::vector<char> read_buf(PAGE_SIZE);
+      for (int round = 0; round < num_rounds; ++round) {
+        auto page_id = static_cast<page_id_t>(round % 10 * num_threads + tid);
+        std::fill(data.begin(), data.end(), static_cast<char>(round + tid));
+        dm.WritePage(page_id, data.data());
+        dm.ReadPage(page_id, read_buf.data());
+        ASSERT_EQ(0, std::memcmp(data.data(), read_buf.data(), PAGE_SIZE));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_rounds, dm.GetNumWrites());
+  EXPECT_EQ(num_threads * num_rounds + 1, dm.GetNumReads());
+  EXPECT_EQ(10 * num_threads * PAGE_SIZE, dm.GetDbFileSize());
+
+  dm.ShutDown();
+
+  // Scenario: a reopened file starts with its size on disk.
+  DiskManager reopened("test.db");
+  EXPECT_EQ(10 * num_threads * PAGE_SIZE, reopened.GetDbFileSize());
+  reopened.ReadPage(10 * num_threads - 1, buf.data());
+  EXPECT_EQ(static_cast<char>(num_rounds - 1 + num_threads - 1), buf[0]);
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  const int num_pages = 4;
+  std::vector<char> data(num_pages * PAGE_SIZE + 1);
+  // Scenario: unaligned buffers are copied through an aligned one, so any buffer works with direct I/O.
+  char *unaligned = data.data() + 1;
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(unaligned + i * PAGE_SIZE, PAGE_SIZE, "page-%d", i);
+  }
+  DiskManager::AlignedBuffer aligned = DiskManager::AllocateAligned(num_pages * PAGE_SIZE);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned.get()) % PAGE_SIZE);
+
+  {
+    // The file system of the test may refuse O_DIRECT, in which case the disk manager falls back to buffered I/O.
+    DiskManager dm("test.db", true);
+    dm.WritePage(0, unaligned);
+    memcpy(aligned.get(), unaligned + PAGE_SIZE, PAGE_SIZE);
+    dm.WritePage(1, aligned.get());
+    dm.WritePages({{3, unaligned + 3 * PAGE_SIZE}, {2, unaligned + 2 * PAGE_SIZE}});
+    EXPECT_EQ(static_cast<uint64_t>(num_pages) * PAGE_SIZE, dm.GetDbFileSize());
+
+    std::vector<char> buf(num_pages * PAGE_SIZE + 1);
+    dm.ReadPages(0, num_pages, buf.data() + 1);
+    EXPECT_EQ(0, std::memcmp(buf.data() + 1, unaligned, num_pages * PAGE_SIZE));
+    dm.ReadPages(0, num_pages, aligned.get());
+    EXPECT_EQ(0, std::memcmp(aligned.get(), unaligned, num_pages * PAGE_SIZE));
+    dm.ReadPage(2, buf.data() + 1);
+    EXPECT_EQ(0, std::memcmp(buf.data() + 1, unaligned + 2 * PAGE_SIZE, PAGE_SIZE));
+    // A page past the end of the file still reads as zeros.
+    dm.ReadPage(num_pages, aligned.get());
+    EXPECT_TRUE(std::all_of(aligned.get(), aligned.get() + PAGE_SIZE, [](char c) { return c == 0; }));
+    dm.ShutDown();
+  }
+
+  // Scenario: the file is the same with buffered I/O.
+  DiskManager dm("test.db");
+  EXPECT_FALSE(dm.IsDirectIo());
+  std::vector<char> buf(num_pages * PAGE_SIZE);
+  dm.ReadPages(0, num_pages, buf.data());
+  EXPECT_EQ(0, std::memcmp(buf.data(), unaligned, num_pages * PAGE_SIZE));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapTest) {
+  std::vector<char> data(PAGE_SIZE, 'x');
+  {
+    DiskManager dm("test.db");
+    for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+    }
+    EXPECT_EQ(0, dm.GetNumFreePages());
+
+    // Scenario: deallocated pages are reused before the file grows, lowest first or close to the hint.
+    for (page_id_t page_id : {7, 3, 5}) {
+      dm.DeallocatePage(page_id);
+      EXPECT_FALSE(dm.IsAllocated(page_id));
+    }
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(42);
+    EXPECT_EQ(3, dm.GetNumFreePages());
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(7, dm.AllocatePage(8));
+    EXPECT_TRUE(dm.IsAllocated(7));
+    EXPECT_EQ(5, dm.AllocatePage(0));
+    EXPECT_EQ(10, dm.AllocatePage());
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    dm.DeallocatePage(9);
+    dm.DeallocatePage(10);
+    dm.WritePage(10, data.data());
+    dm.ShutDown();
+  }
+
+  // Scenario: the map survives a restart, including free pages at the end of the file.
+  {
+    DiskManager dm("test.db");
+    EXPECT_EQ(2, dm.GetNumFreePages());
+    EXPECT_TRUE(dm.IsAllocated(8));
+    EXPECT_FALSE(dm.IsAllocated(9));
+    EXPECT_EQ(9, dm.AllocatePage());
+    EXPECT_EQ(10, dm.AllocatePage());
+    EXPECT_EQ(11, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: the map is kept in the db file, with a page of the map before each FSM_PAGE_BITS pages. Pages on both
+  // sides of the second one are written and read as one run, and the file size does not count the map.
+  const auto bits = static_cast<page_id_t>(DiskManager::FSM_PAGE_BITS);
+  std::vector<char> run(2 * PAGE_SIZE);
+  std::fill(run.begin(), run.begin() + PAGE_SIZE, 'a');
+  std::fill(run.begin() + PAGE_SIZE, run.end(), 'b');
+  {
+    DiskManager dm("test.db");
+    while (dm.AllocatePage() < bits) {
+    }
+    dm.WritePages({{bits - 1, run.data()}, {bits, run.data() + PAGE_SIZE}});
+    EXPECT_EQ(static_cast<uint64_t>(bits + 1) * PAGE_SIZE, dm.GetDbFileSize());
+    dm.ShutDown();
+  }
+  {
+    DiskManager dm("test.db");
+    EXPECT_EQ(static_cast<uint64_t>(bits + 1) * PAGE_SIZE, dm.GetDbFileSize());
+    EXPECT_TRUE(dm.IsAllocated(bits));
+    std::vector<char> buf(2 * PAGE_SIZE);
+    dm.ReadPages(bits - 1, 2, buf.data());
+    EXPECT_EQ(run, buf);
+    EXPECT_EQ(bits + 1, dm.AllocatePage(bits));
+    dm.ShutDown();
+  }
+
+  // Scenario: the map is synced before a new page is first written, so the page is still allocated after a crash,
+  // which a second disk manager on the file without a ShutDown of the first stands in for.
+  {
+    DiskManager dm("test.db");
+    page_id_t page_id = dm.AllocatePage();
+    dm.WritePage(page_id, data.data());
+    DiskManager after_crash("test.db");
+    EXPECT_TRUE(after_crash.IsAllocated(page_id));
+    EXPECT_NE(page_id, after_crash.AllocatePage());
+    after_crash.ShutDown();
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentTest) {
+  const page_id_t extent_size = DiskManager::EXTENT_SIZE;
+  const owner_id_t table = 0;
+  const owner_id_t index = 1;
+  std::vector<char> data(PAGE_SIZE, 'x');
+  {
+    DiskManager dm("test.db");
+    EXPECT_EQ(0, dm.AllocatePage());
+
+    // Scenario: the pages of two owners that allocate in turns are not interleaved, but in runs of an extent.
+    std::vector<page_id_t> table_pages;
+    std::vector<page_id_t> index_pages;
+    for (int i = 0; i < 2 * extent_size; ++i) {
+      table_pages.push_back(dm.AllocatePage(INVALID_PAGE_ID, table));
+      index_pages.push_back(dm.AllocatePage(INVALID_PAGE_ID, index));
+    }
+    for (auto *pages : {&table_pages, &index_pages}) {
+      for (size_t i = 0; i < pages->size(); ++i) {
+        EXPECT_EQ(0, (*pages)[i] % extent_size - static_cast<page_id_t>(i) % extent_size);
+      }
+    }
+    EXPECT_NE(table_pages[extent_size - 1] + 1, table_pages[extent_size]);
+
+    // Scenario: pages without an owner go to the rest of the extent that holds page 0, which no owner could reserve.
+    EXPECT_EQ(1, dm.AllocatePage());
+    EXPECT_EQ(extent_size - 2, dm.GetNumFreePages());
+
+    // Scenario: a page deallocated in the current extent of its owner is reused by that owner.
+    page_id_t page_id = dm.AllocatePage(INVALID_PAGE_ID, table);
+    EXPECT_EQ(0, page_id % extent_size);
+    EXPECT_EQ(page_id + 1, dm.AllocatePage(INVALID_PAGE_ID, table));
+    dm.DeallocatePage(page_id);
+    EXPECT_EQ(page_id, dm.AllocatePage(INVALID_PAGE_ID, table));
+
+    // Scenario: once an owner releases its extent, its free pages go to pages without an owner.
+    page_id_t index_page_id = dm.AllocatePage(INVALID_PAGE_ID, index);
+    for (page_id_t i = 0; i < extent_size - 2; ++i) {
+      EXPECT_GT(extent_size, dm.AllocatePage());
+    }
+    dm.ReleaseOwner(index);
+    EXPECT_EQ(index_page_id + 1, dm.AllocatePage());
+
+    // Scenario: a retired owner is released by the next allocation, after the free pages below its extent.
+    DiskManager::RetireOwner(table);
+    page_id_t next_page_id = dm.AllocatePage();
+    while (next_page_id < page_id) {
+      next_page_id = dm.AllocatePage();
+    }
+    EXPECT_EQ(page_id + 2, next_page_id);
+    dm.WritePage(page_id + 1, data.data());
+    dm.ShutDown();
+  }
+
+  // Scenario: reservations are not persistent, so the unused pages of an extent are free after a restart.
+  DiskManager dm("test.db");
+  size_t num_free = dm.GetNumFreePages();
+  EXPECT_LT(0, num_free);
+  EXPECT_EQ(num_free - 1, (dm.AllocatePage(), dm.GetNumFreePages()));
+  dm.ShutDown();
+}
+
+// Time to write back scattered dirty pages one at a time versus sorted and coalesced with one sync.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_WritePagesBenchmark) {
+  const int num_pages = 4096;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<char> data(PAGE_SIZE, 'x');
+
+  std::vector<page_id_t> page_ids(num_pages);
+  for (int i = 0; i < num_pages; ++i) {
+    page_ids[i] = i;
+  }
+  std::shuffle(page_ids.begin(), page_ids.end(), std::mt19937(15445));
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : page_ids) {
+    dm.WritePage(page_id, data.data());
+  }
+  auto one_by_one = std::chrono::steady_clock::now() - start;
+
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (auto page_id : page_ids) {
+    pages.emplace_back(page_id, data.data());
+  }
+  start = std::chrono::steady_clock::now();
+  dm.WritePages(pages);
+  auto coalesced = std::chrono::steady_clock::now() - start;
+
+  std::cout << num_pages << " pages: WritePage "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(one_by_one).count() << " ms, WritePages "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(coalesced).count() << " ms" << std::endl;
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +381,109 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MemoryBackendTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  DiskManagerMemory dm;
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a page that was never written reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: WritePages and ReadPages move runs of pages, and count one I/O per run.
+  std::vector<std::vector<char>> pages(4, std::vector<char>(PAGE_SIZE));
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    std::fill(pages[i].begin(), pages[i].end(), static_cast<char>('a' + i));
+    writes.emplace_back(static_cast<page_id_t>(10 + i), pages[i].data());
+  }
+  int num_writes = dm.GetNumWrites();
+  dm.WritePages(writes);
+  EXPECT_EQ(num_writes + 1, dm.GetNumWrites());
+  std::vector<char> run(pages.size() * PAGE_SIZE);
+  dm.ReadPages(10, pages.size(), run.data());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    EXPECT_EQ(pages[i], std::vector<char>(run.begin() + i * PAGE_SIZE, run.begin() + (i + 1) * PAGE_SIZE));
+  }
+
+  // Scenario: pages are allocated and reused as with files.
+  page_id_t page_id = dm.AllocatePage();
+  EXPECT_TRUE(dm.IsAllocated(page_id));
+  dm.DeallocatePage(page_id);
+  EXPECT_FALSE(dm.IsAllocated(page_id));
+  EXPECT_EQ(page_id, dm.AllocatePage());
+
+  // Scenario: the log is appended to and read back at any offset.
+  dm.WriteLog(data, 16);
+  dm.WriteLog(data + 2, 16);
+  EXPECT_EQ(2, dm.GetNumFlushes());
+  char log[16];
+  EXPECT_TRUE(dm.ReadLog(log, sizeof(log), 16));
+  EXPECT_EQ(std::memcmp(log, data + 2, sizeof(log)), 0);
+  EXPECT_FALSE(dm.ReadLog(log, sizeof(log), 32));
+
+  size_t size;
+  EXPECT_EQ(nullptr, dm.MapDbFile(&size));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SlowBackendTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  DiskManagerMemory memory;
+  SlowDiskOptions options;
+  options.read_latency_ = std::chrono::milliseconds(20);
+  options.write_latency_ = std::chrono::milliseconds(10);
+  options.queue_depth_ = 1;
+  DiskManagerSlow dm(&memory, options);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_LE(std::chrono::milliseconds(30), elapsed);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(1, dm.GetNumWrites());
+  EXPECT_EQ(1, dm.GetNumReads());
+
+  // Scenario: with a queue depth of 1, concurrent reads wait for each other.
+  start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&dm] {
+      char page[PAGE_SIZE];
+      dm.ReadPage(0, page);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(std::chrono::milliseconds(80), std::chrono::steady_clock::now() - start);
+
+  // Scenario: the bandwidth bounds the transfer of a run of pages.
+  SlowDiskOptions bandwidth_options;
+  bandwidth_options.bandwidth_ = 100 * PAGE_SIZE;
+  DiskManagerSlow bandwidth_dm(&memory, bandwidth_options);
+  std::vector<char> run(5 * PAGE_SIZE);
+  start = std::chrono::steady_clock::now();
+  bandwidth_dm.ReadPages(0, 5, run.data());
+  EXPECT_LE(std::chrono::milliseconds(50), std::chrono::steady_clock::now() - start);
+
+  // Scenario: allocation goes to the wrapped disk manager.
+  page_id_t page_id = dm.AllocatePage();
+  EXPECT_TRUE(memory.IsAllocated(page_id));
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
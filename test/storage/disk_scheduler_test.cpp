@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ScheduleTest) {
+  const size_t num_pages = 100;
+  for (bool use_io_uring : {true, false}) {
+    DiskManager dm("test.db");
+    auto *scheduler = new DiskScheduler(&dm, use_io_uring);
+
+    // Scenario: a batch of writes completes, and every page reads back what was written.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<DiskRequest> writes;
+    std::vector<std::future<bool>> futures;
+    for (size_t i = 0; i < num_pages; ++i) {
+      snprintf(data[i].data(), PAGE_SIZE, "page-%zu", i);
+      auto promise = scheduler->CreatePromise();
+      futures.push_back(promise.get_future());
+      writes.push_back(DiskRequest{true, data[i].data(), static_cast<page_id_t>(i), std::move(promise)});
+    }
+    scheduler->Schedule(std::move(writes));
+    for (auto &future : futures) {
+      EXPECT_TRUE(future.get());
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    EXPECT_EQ(num_pages * PAGE_SIZE, dm.GetDbFileSize());
+
+    futures.clear();
+    std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto promise = scheduler->CreatePromise();
+      futures.push_back(promise.get_future());
+      scheduler->Schedule(DiskRequest{false, buf[i].data(), static_cast<page_id_t>(i), std::move(promise)});
+    }
+    for (size_t i = 0; i < num_pages; ++i) {
+      EXPECT_TRUE(futures[i].get());
+      EXPECT_EQ(0, memcmp(data[i].data(), buf[i].data(), PAGE_SIZE));
+    }
+    EXPECT_EQ(num_pages, dm.GetNumReads());
+
+    // Scenario: a page past the end of the file reads as zeros.
+    memset(buf[0].data(), 'x', PAGE_SIZE);
+    EXPECT_TRUE(scheduler->ReadPage(num_pages + 5, buf[0].data()));
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), buf[0]);
+    EXPECT_TRUE(scheduler->WritePage(0, data[1].data()));
+    EXPECT_TRUE(scheduler->ReadPage(0, buf[0].data()));
+    EXPECT_EQ(data[1], buf[0]);
+
+    // Scenario: requests still queued at destruction are completed.
+    futures.clear();
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto promise = scheduler->CreatePromise();
+      futures.push_back(promise.get_future());
+      scheduler->Schedule(DiskRequest{false, buf[i].data(), static_cast<page_id_t>(i), std::move(promise)});
+    }
+    delete scheduler;
+    for (auto &future : futures) {
+      EXPECT_TRUE(future.get());
+    }
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// Random 4 KB reads from a file larger than the page cache would normally keep warm, with a fixed number of reads
+// outstanding at a time.
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, DISABLED_RandomReadBenchmark) {
+  const size_t num_pages = 16384;
+  const size_t num_reads = 20000;
+  DiskManager dm("test.db");
+  {
+    std::vector<char> data(PAGE_SIZE, 'x');
+    for (size_t i = 0; i < num_pages; ++i) {
+      dm.WritePage(static_cast<page_id_t>(i), data.data());
+    }
+  }
+
+  for (bool use_io_uring : {true, false}) {
+    DiskScheduler scheduler(&dm, use_io_uring);
+    for (size_t queue_depth : {1, 4, 16, 64}) {
+      std::vector<std::vector<char>> buf(queue_depth, std::vector<char>(PAGE_SIZE));
+      std::vector<std::future<bool>> futures(queue_depth);
+      std::mt19937 rng(0);
+      std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages) - 1);
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_reads; ++i) {
+        size_t slot = i % queue_depth;
+        if (futures[slot].valid()) {
+          futures[slot].get();
+        }
+        auto promise = scheduler.CreatePromise();
+        futures[slot] = promise.get_future();
+        scheduler.Schedule(DiskRequest{false, buf[slot].data(), dist(rng), std::move(promise)});
+      }
+      for (auto &future : futures) {
+        future.get();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << (scheduler.UsesIoUring() ? "io_uring" : "threads") << " queue_depth=" << queue_depth
+                << " reads/sec=" << num_reads * 1000000 / elapsed.count() << std::endl;
+    }
+  }
+
+  dm.ShutDown();
+}
+
+}  // namespace bustub
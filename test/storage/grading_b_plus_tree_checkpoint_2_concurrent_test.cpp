@@ -9,7 +9,7 @@
 #include <thread>  // NOLINT
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -131,7 +131,7 @@ void InsertTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -186,7 +186,7 @@ void InsertTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -241,7 +241,7 @@ void DeleteTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -285,7 +285,7 @@ void DeleteTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -330,7 +330,7 @@ void MixTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
 
@@ -392,7 +392,7 @@ void MixTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -461,7 +461,7 @@ void MixTest3Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
 
@@ -16,11 +16,12 @@
 #include <string>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -39,7 +40,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   // create transaction
   auto *transaction = new Transaction(0);
   auto *disk_manager = new DiskManager("test.db");
-  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
   auto *lock_manager = new LockManager();
   auto *log_manager = new LogManager(disk_manager);
   auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
@@ -71,4 +72,56 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapExtentTest) {
+  Column col1{"a", TypeId::VARCHAR, 1000};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(1000, 'x')), ValueFactory::GetBigIntValue(1)};
+  Tuple tuple(values, &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(256, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *orders = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto *lineitems = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Scenario: two tables that grow at the same time get contiguous runs of pages instead of alternating ones.
+  for (int i = 0; i < 300; ++i) {
+    RID rid;
+    ASSERT_TRUE(orders->InsertTuple(tuple, &rid, transaction));
+    ASSERT_TRUE(lineitems->InsertTuple(tuple, &rid, transaction));
+  }
+  for (auto *table : {orders, lineitems}) {
+    int num_pages = 0;
+    int num_sequential = 0;
+    page_id_t page_id = table->GetFirstPageId();
+    while (page_id != INVALID_PAGE_ID) {
+      auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+      ASSERT_NE(nullptr, page);
+      page_id_t next_page_id = page->GetNextPageId();
+      buffer_pool_manager->UnpinPage(page_id, false);
+      num_sequential += next_page_id == page_id + 1 ? 1 : 0;
+      ++num_pages;
+      page_id = next_page_id;
+    }
+    EXPECT_LT(DiskManager::EXTENT_SIZE, num_pages);
+    EXPECT_LE(num_pages - 1 - num_pages / DiskManager::EXTENT_SIZE, num_sequential);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete orders;
+  delete lineitems;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub
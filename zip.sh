@@ -5,7 +5,30 @@ zip project1-submission.zip \
 src/include/buffer/lru_replacer.h \
 src/buffer/lru_replacer.cpp \
 src/include/buffer/buffer_pool_manager.h \
-src/buffer/buffer_pool_manager.cpp 
+src/include/buffer/buffer_pool_manager_instance.h \
+src/buffer/buffer_pool_manager_instance.cpp \
+src/include/buffer/parallel_buffer_pool_manager.h \
+src/buffer/parallel_buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_set.h \
+src/buffer/buffer_pool_set.cpp \
+src/include/buffer/compressed_page_cache.h \
+src/buffer/compressed_page_cache.cpp \
+src/include/buffer/frame_arena.h \
+src/buffer/frame_arena.cpp \
+src/include/buffer/lru_k_replacer.h \
+src/buffer/lru_k_replacer.cpp \
+src/include/buffer/mmap_buffer_pool_manager.h \
+src/buffer/mmap_buffer_pool_manager.cpp \
+src/include/buffer/page_codec.h \
+src/buffer/page_codec.cpp \
+src/include/buffer/page_table.h \
+src/buffer/page_table.cpp \
+src/include/storage/disk/disk_manager_memory.h \
+src/storage/disk/disk_manager_memory.cpp \
+src/include/storage/disk/disk_manager_slow.h \
+src/storage/disk/disk_manager_slow.cpp \
+src/include/storage/disk/disk_scheduler.h \
+src/storage/disk/disk_scheduler.cpp 
 
 
 zip project2-submission.zip \
@@ -16,13 +39,40 @@ src/include/storage/page/b_plus_tree_internal_page.h \
 src/storage/page/b_plus_tree_internal_page.cpp \
 src/include/storage/page/b_plus_tree_leaf_page.h \
 src/storage/page/b_plus_tree_leaf_page.cpp \
+src/include/storage/page/compressed_key_array.h \
+src/storage/page/compressed_key_array.cpp \
+src/include/storage/index/external_sorter.h \
+src/storage/index/external_sorter.cpp \
 src/include/storage/index/b_plus_tree.h \
 src/include/storage/index/index_iterator.h \
 src/storage/index/index_iterator.cpp \
 src/include/buffer/lru_replacer.h \
 src/buffer/lru_replacer.cpp \
 src/include/buffer/buffer_pool_manager.h \
-src/buffer/buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_manager_instance.h \
+src/buffer/buffer_pool_manager_instance.cpp \
+src/include/buffer/parallel_buffer_pool_manager.h \
+src/buffer/parallel_buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_set.h \
+src/buffer/buffer_pool_set.cpp \
+src/include/buffer/compressed_page_cache.h \
+src/buffer/compressed_page_cache.cpp \
+src/include/buffer/frame_arena.h \
+src/buffer/frame_arena.cpp \
+src/include/buffer/lru_k_replacer.h \
+src/buffer/lru_k_replacer.cpp \
+src/include/buffer/mmap_buffer_pool_manager.h \
+src/buffer/mmap_buffer_pool_manager.cpp \
+src/include/buffer/page_codec.h \
+src/buffer/page_codec.cpp \
+src/include/buffer/page_table.h \
+src/buffer/page_table.cpp \
+src/include/storage/disk/disk_manager_memory.h \
+src/storage/disk/disk_manager_memory.cpp \
+src/include/storage/disk/disk_manager_slow.h \
+src/storage/disk/disk_manager_slow.cpp \
+src/include/storage/disk/disk_scheduler.h \
+src/storage/disk/disk_scheduler.cpp \
 src/include/storage/page/tmp_tuple_page.h
 
 
@@ -34,13 +84,40 @@ src/include/storage/page/b_plus_tree_internal_page.h \
 src/storage/page/b_plus_tree_internal_page.cpp \
 src/include/storage/page/b_plus_tree_leaf_page.h \
 src/storage/page/b_plus_tree_leaf_page.cpp \
+src/include/storage/page/compressed_key_array.h \
+src/storage/page/compressed_key_array.cpp \
+src/include/storage/index/external_sorter.h \
+src/storage/index/external_sorter.cpp \
 src/include/storage/index/b_plus_tree.h \
 src/include/storage/index/index_iterator.h \
 src/storage/index/index_iterator.cpp \
 src/include/buffer/lru_replacer.h \
 src/buffer/lru_replacer.cpp \
 src/include/buffer/buffer_pool_manager.h \
-src/buffer/buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_manager_instance.h \
+src/buffer/buffer_pool_manager_instance.cpp \
+src/include/buffer/parallel_buffer_pool_manager.h \
+src/buffer/parallel_buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_set.h \
+src/buffer/buffer_pool_set.cpp \
+src/include/buffer/compressed_page_cache.h \
+src/buffer/compressed_page_cache.cpp \
+src/include/buffer/frame_arena.h \
+src/buffer/frame_arena.cpp \
+src/include/buffer/lru_k_replacer.h \
+src/buffer/lru_k_replacer.cpp \
+src/include/buffer/mmap_buffer_pool_manager.h \
+src/buffer/mmap_buffer_pool_manager.cpp \
+src/include/buffer/page_codec.h \
+src/buffer/page_codec.cpp \
+src/include/buffer/page_table.h \
+src/buffer/page_table.cpp \
+src/include/storage/disk/disk_manager_memory.h \
+src/storage/disk/disk_manager_memory.cpp \
+src/include/storage/disk/disk_manager_slow.h \
+src/storage/disk/disk_manager_slow.cpp \
+src/include/storage/disk/disk_scheduler.h \
+src/storage/disk/disk_scheduler.cpp \
 src/include/storage/page/tmp_tuple_page.h \
 src/include/catalog/catalog.h \
 src/include/execution/execution_engine.h \
@@ -76,13 +153,40 @@ src/include/storage/page/b_plus_tree_internal_page.h \
 src/storage/page/b_plus_tree_internal_page.cpp \
 src/include/storage/page/b_plus_tree_leaf_page.h \
 src/storage/page/b_plus_tree_leaf_page.cpp \
+src/include/storage/page/compressed_key_array.h \
+src/storage/page/compressed_key_array.cpp \
+src/include/storage/index/external_sorter.h \
+src/storage/index/external_sorter.cpp \
 src/include/storage/index/b_plus_tree.h \
 src/include/storage/index/index_iterator.h \
 src/storage/index/index_iterator.cpp \
 src/include/buffer/lru_replacer.h \
 src/buffer/lru_replacer.cpp \
 src/include/buffer/buffer_pool_manager.h \
-src/buffer/buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_manager_instance.h \
+src/buffer/buffer_pool_manager_instance.cpp \
+src/include/buffer/parallel_buffer_pool_manager.h \
+src/buffer/parallel_buffer_pool_manager.cpp \
+src/include/buffer/buffer_pool_set.h \
+src/buffer/buffer_pool_set.cpp \
+src/include/buffer/compressed_page_cache.h \
+src/buffer/compressed_page_cache.cpp \
+src/include/buffer/frame_arena.h \
+src/buffer/frame_arena.cpp \
+src/include/buffer/lru_k_replacer.h \
+src/buffer/lru_k_replacer.cpp \
+src/include/buffer/mmap_buffer_pool_manager.h \
+src/buffer/mmap_buffer_pool_manager.cpp \
+src/include/buffer/page_codec.h \
+src/buffer/page_codec.cpp \
+src/include/buffer/page_table.h \
+src/buffer/page_table.cpp \
+src/include/storage/disk/disk_manager_memory.h \
+src/storage/disk/disk_manager_memory.cpp \
+src/include/storage/disk/disk_manager_slow.h \
+src/storage/disk/disk_manager_slow.cpp \
+src/include/storage/disk/disk_scheduler.h \
+src/storage/disk/disk_scheduler.cpp \
 src/include/storage/page/tmp_tuple_page.h \
 src/include/catalog/catalog.h \
 src/include/execution/execution_engine.h \